@@ -0,0 +1,51 @@
+#!/usr/bin/env bash
+#
+# Runs the same generated program on the bytecode VM and as C emitted with
+# --emit-c, and prints the time taken by each step.
+#
+# Usage: benchmark/run.sh [CONJOINT] [STATEMENTS]
+
+set -e
+
+conjoint=${1:-./build/Default/conjoint}
+statements=${2:-20000}
+cc=${CC:-cc}
+directory=$(mktemp -d)
+trap 'rm -rf "$directory"' EXIT
+
+# Conjoint has no loops yet, so the workload is a long chain of dependent
+# arithmetic that the constant folder can not remove.
+awk -v statements="$statements" 'BEGIN {
+    print "import { printLine } from \"io\";"
+    print "let x0:Number = 1;"
+    print "let y0:Boolean = true;"
+    for (i = 1; i < statements; i++) {
+        printf "let x%d:Number = (x%d * 31 + %d) %% 1000003;\n", i, i - 1, i
+        printf "let y%d:Boolean = y%d != x%d > 500000;\n", i, i - 1, i
+        if (i % 1000 == 0) {
+            printf "printLine(x%d ^ x%d >>> 3);\n", i, i - 1
+        }
+    }
+    printf "printLine(y%d);\n", statements - 1
+}' > "$directory/program.cj"
+
+TIMEFORMAT="%R s"
+
+echo "interpreter (parse, compile and run):"
+time "$conjoint" "$directory/program.cj" > "$directory/interpreter.out"
+
+echo "emit C:"
+time "$conjoint" --emit-c "$directory/program.cj" > "$directory/program.c"
+
+echo "compile C ($cc -O2):"
+time "$cc" -O2 -o "$directory/program" "$directory/program.c" -lm
+
+echo "emitted C (run):"
+time "$directory/program" > "$directory/emitted.out"
+
+if cmp -s "$directory/interpreter.out" "$directory/emitted.out"; then
+    echo "outputs match"
+else
+    echo "outputs differ" >&2
+    exit 1
+fi
@@ -1,12 +1,94 @@
 {
+    "variables": {
+        "profile%": 0,
+        "frontend_sources": [
+            "src/allocator.c",
+            "src/arena.c",
+            "src/ast.c",
+            "src/binding_table.c",
+            "src/diagnostic.c",
+            "src/fold.c",
+            "src/name_index.c",
+            "src/operator.c",
+            "src/parser.c",
+            "src/profiler.c",
+            "src/source_file.c",
+            "src/symbol_table.c",
+            "src/tokenizer.c",
+            "src/type_checker.c",
+            "src/utf8.c",
+            "src/value.c"
+        ],
+        "standard_modules": [
+            "lib/math.cj"
+        ]
+    },
+    "target_defaults": {
+        "conditions": [
+            ["OS==\"linux\"", {
+                "link_settings": {
+                    "libraries": ["-lm"]
+                }
+            }],
+            ["profile==1", {
+                "defines": ["CJ_PROFILE"]
+            }]
+        ]
+    },
     "targets": [
+        {
+            "target_name": "embed_standard_modules",
+            "type": "executable",
+            "sources": [
+                "<@(frontend_sources)",
+                "src/embed_standard_modules.c"
+            ]
+        },
         {
             "target_name": "conjoint",
             "type": "executable",
+            "dependencies": [
+                "embed_standard_modules"
+            ],
+            "include_dirs": [
+                "src"
+            ],
+            "actions": [
+                {
+                    "action_name": "embed_standard_modules",
+                    "inputs": [
+                        "<(PRODUCT_DIR)/<(EXECUTABLE_PREFIX)embed_standard_modules<(EXECUTABLE_SUFFIX)",
+                        "<@(standard_modules)"
+                    ],
+                    "outputs": [
+                        "<(INTERMEDIATE_DIR)/standard_modules.c"
+                    ],
+                    "action": [
+                        "<(PRODUCT_DIR)/<(EXECUTABLE_PREFIX)embed_standard_modules<(EXECUTABLE_SUFFIX)",
+                        "<@(_outputs)",
+                        "<@(standard_modules)"
+                    ],
+                    "process_outputs_as_sources": 1
+                }
+            ],
+            "conditions": [
+                ["OS==\"linux\"", {
+                    "sources": [
+                        "src/watch.c"
+                    ]
+                }]
+            ],
             "sources": [
+                "<@(frontend_sources)",
+                "src/bytecode.c",
+                "src/c_emitter.c",
+                "src/compiler.c",
                 "src/conjoint.c",
-                "src/source_file.c",
-                "src/tokenizer.c"
+                "src/io_module.c",
+                "src/native_module.c",
+                "src/prune.c",
+                "src/standard_module.c",
+                "src/vm.c"
             ]
         }
     ]
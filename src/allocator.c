@@ -0,0 +1,118 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "allocator.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char* memory_subsystem_strings[] = {
+    "source file",
+    "syntax tree",
+    "symbol table",
+    "diagnostic",
+    "name index",
+    "general"
+};
+
+static void* cj_allocate_system_memory(struct cj_allocator* allocator, size_t size) {
+    (void) allocator;
+    return malloc(size);
+}
+
+static void* cj_reallocate_system_memory(struct cj_allocator* allocator, void* pointer, size_t old_size, size_t new_size) {
+    (void) allocator;
+    (void) old_size;
+    return realloc(pointer, new_size);
+}
+
+static void cj_deallocate_system_memory(struct cj_allocator* allocator, void* pointer, size_t size) {
+    (void) allocator;
+    (void) size;
+    free(pointer);
+}
+
+void cj_init_allocator(struct cj_allocator* allocator) {
+    *allocator = (struct cj_allocator) {
+        .allocate = cj_allocate_system_memory,
+        .reallocate = cj_reallocate_system_memory,
+        .deallocate = cj_deallocate_system_memory
+    };
+}
+
+static void cj_account_memory(struct cj_allocator* allocator, enum cj_memory_subsystem subsystem, size_t old_size, size_t new_size) {
+    struct cj_memory_usage* usage = &allocator->usage[subsystem];
+
+    allocator->bytes = allocator->bytes - old_size + new_size;
+    usage->bytes = usage->bytes - old_size + new_size;
+    if (usage->bytes > usage->peak_bytes) {
+        usage->peak_bytes = usage->bytes;
+    }
+}
+
+static bool cj_check_memory_limit(const struct cj_allocator* allocator, size_t old_size, size_t new_size) {
+    return allocator->limit == 0 || new_size <= old_size || allocator->bytes - old_size + new_size <= allocator->limit;
+}
+
+void* cj_allocate(struct cj_allocator* allocator, enum cj_memory_subsystem subsystem, size_t size) {
+    allocator->usage[subsystem].calls++;
+
+    if (!cj_check_memory_limit(allocator, 0, size)) {
+        return NULL;
+    }
+
+    void* pointer = allocator->allocate(allocator, size);
+    if (pointer != NULL) {
+        cj_account_memory(allocator, subsystem, 0, size);
+    }
+    return pointer;
+}
+
+void* cj_reallocate(struct cj_allocator* allocator, enum cj_memory_subsystem subsystem, void* pointer, size_t old_size, size_t new_size) {
+    allocator->usage[subsystem].calls++;
+
+    if (!cj_check_memory_limit(allocator, old_size, new_size)) {
+        return NULL;
+    }
+
+    void* resized = allocator->reallocate(allocator, pointer, old_size, new_size);
+    if (resized != NULL) {
+        cj_account_memory(allocator, subsystem, old_size, new_size);
+    }
+    return resized;
+}
+
+void cj_deallocate(struct cj_allocator* allocator, enum cj_memory_subsystem subsystem, void* pointer, size_t size) {
+    if (pointer != NULL) {
+        allocator->deallocate(allocator, pointer, size);
+        cj_account_memory(allocator, subsystem, size, 0);
+    }
+}
+
+void cj_print_memory_usage(const struct cj_allocator* allocator, FILE* stream) {
+    fprintf(stream, "%-14s %12s %12s %10s\n", "memory", "bytes", "peak bytes", "calls");
+
+    for (int i = 0; i < CJ_MEMORY_SUBSYSTEMS_LENGTH; i++) {
+        const struct cj_memory_usage* usage = &allocator->usage[i];
+        fprintf(stream, "%-14s %12zu %12zu %10zu\n", memory_subsystem_strings[i], usage->bytes, usage->peak_bytes, usage->calls);
+    }
+}
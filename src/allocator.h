@@ -0,0 +1,72 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_ALLOCATOR_H_
+#define CONJOINT_SRC_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+enum cj_memory_subsystem {
+    SOURCE_FILE_MEMORY,
+    SYNTAX_TREE_MEMORY,
+    SYMBOL_TABLE_MEMORY,
+    DIAGNOSTIC_MEMORY,
+    NAME_INDEX_MEMORY,
+    GENERAL_MEMORY
+};
+
+#define CJ_MEMORY_SUBSYSTEMS_LENGTH (GENERAL_MEMORY + 1)
+
+struct cj_memory_usage {
+    size_t bytes;
+    size_t peak_bytes;
+    size_t calls;
+};
+
+/* Memory source of the front end. Embedders can replace the functions,
+ * typically with the allocator as the first member of a larger structure
+ * holding their pool. The functions return NULL on failure, and so does
+ * cj_allocate when the allocation would exceed `limit`. */
+struct cj_allocator {
+    void* (*allocate)(struct cj_allocator* allocator, size_t size);
+    void* (*reallocate)(struct cj_allocator* allocator, void* pointer, size_t old_size, size_t new_size);
+    void (*deallocate)(struct cj_allocator* allocator, void* pointer, size_t size);
+
+    /* Maximum of bytes allocated at once, or 0 for no limit. */
+    size_t limit;
+    size_t bytes;
+
+    struct cj_memory_usage usage[CJ_MEMORY_SUBSYSTEMS_LENGTH];
+};
+
+/* Uses malloc, realloc and free, without limit. */
+void cj_init_allocator(struct cj_allocator* allocator);
+
+void* cj_allocate(struct cj_allocator* allocator, enum cj_memory_subsystem subsystem, size_t size);
+
+void* cj_reallocate(struct cj_allocator* allocator, enum cj_memory_subsystem subsystem, void* pointer, size_t old_size, size_t new_size);
+
+void cj_deallocate(struct cj_allocator* allocator, enum cj_memory_subsystem subsystem, void* pointer, size_t size);
+
+void cj_print_memory_usage(const struct cj_allocator* allocator, FILE* stream);
+
+#endif /* CONJOINT_SRC_ALLOCATOR_H_ */
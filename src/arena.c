@@ -0,0 +1,145 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "arena.h"
+
+#include <setjmp.h>
+#include <stddef.h>
+#include <string.h>
+
+#define CJ_ARENA_CHUNK_SIZE 16384
+
+#define cj_arena_align(size) \
+    (((size) + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1))
+
+static struct cj_arena_chunk* cj_init_arena_chunk(struct cj_arena* arena, size_t size) {
+    struct cj_arena_chunk* chunk = cj_allocate(arena->allocator, arena->subsystem, sizeof(struct cj_arena_chunk) + size);
+
+    if (chunk == NULL) {
+        if (arena->failure_point != NULL) {
+            longjmp(*arena->failure_point, CJ_OUT_OF_MEMORY);
+        }
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+void cj_init_arena(struct cj_arena* arena, struct cj_allocator* allocator, enum cj_memory_subsystem subsystem) {
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->allocator = allocator;
+    arena->subsystem = subsystem;
+    arena->failure_point = NULL;
+}
+
+void* cj_arena_allocate(struct cj_arena* arena, size_t size) {
+    size = cj_arena_align(size);
+
+    if (arena->current == NULL) {
+        arena->first = cj_init_arena_chunk(arena, size > CJ_ARENA_CHUNK_SIZE ? size : CJ_ARENA_CHUNK_SIZE);
+        arena->current = arena->first;
+
+        if (arena->current == NULL) {
+            return NULL;
+        }
+    }
+
+    while (arena->current->size - arena->current->used < size) {
+        struct cj_arena_chunk* next = arena->current->next;
+
+        if (next == NULL || next->size < size) {
+            struct cj_arena_chunk* chunk = cj_init_arena_chunk(arena, size > CJ_ARENA_CHUNK_SIZE ? size : CJ_ARENA_CHUNK_SIZE);
+            if (chunk == NULL) {
+                return NULL;
+            }
+            chunk->next = next;
+            arena->current->next = chunk;
+            next = chunk;
+        }
+
+        arena->current = next;
+        arena->current->used = 0;
+    }
+
+    void* pointer = (char*) arena->current->data + arena->current->used;
+    arena->current->used += size;
+    return pointer;
+}
+
+void* cj_arena_reallocate(struct cj_arena* arena, void* pointer, size_t old_size, size_t new_size) {
+    struct cj_arena_chunk* chunk = arena->current;
+
+    if (pointer != NULL && chunk != NULL
+            && (char*) pointer + cj_arena_align(old_size) == (char*) chunk->data + chunk->used
+            && chunk->size - chunk->used + cj_arena_align(old_size) >= cj_arena_align(new_size)) {
+        chunk->used += cj_arena_align(new_size) - cj_arena_align(old_size);
+        return pointer;
+    }
+
+    void* resized = cj_arena_allocate(arena, new_size);
+    if (pointer != NULL && resized != NULL) {
+        memcpy(resized, pointer, old_size);
+    }
+    return resized;
+}
+
+struct cj_arena_mark cj_mark_arena(const struct cj_arena* arena) {
+    struct cj_arena_mark mark = {
+        .chunk = arena->current,
+        .used = arena->current ? arena->current->used : 0
+    };
+    return mark;
+}
+
+void cj_rewind_arena(struct cj_arena* arena, struct cj_arena_mark mark) {
+    if (mark.chunk == NULL) {
+        cj_reset_arena(arena);
+        return;
+    }
+
+    arena->current = mark.chunk;
+    arena->current->used = mark.used;
+}
+
+void cj_reset_arena(struct cj_arena* arena) {
+    arena->current = arena->first;
+
+    if (arena->current != NULL) {
+        arena->current->used = 0;
+    }
+}
+
+void cj_release_arena(struct cj_arena* arena) {
+    struct cj_arena_chunk* chunk = arena->first;
+
+    while (chunk != NULL) {
+        struct cj_arena_chunk* next = chunk->next;
+        cj_deallocate(arena->allocator, arena->subsystem, chunk, sizeof(struct cj_arena_chunk) + chunk->size);
+        chunk = next;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+}
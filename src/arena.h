@@ -0,0 +1,74 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_ARENA_H_
+#define CONJOINT_SRC_ARENA_H_
+
+#include "allocator.h"
+
+#include <setjmp.h>
+#include <stddef.h>
+
+/* Value passed to longjmp when an arena with a failure point runs out of
+ * memory. */
+#define CJ_OUT_OF_MEMORY 2
+
+struct cj_arena_chunk {
+    struct cj_arena_chunk* next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+};
+
+/* Bump allocator. Chunks are kept across resets and rewinds, so a warmed up
+ * arena serves new allocations without touching the allocator.
+ *
+ * Allocations return NULL when the allocator fails, unless `failure_point`
+ * is set, in which case they longjmp there with CJ_OUT_OF_MEMORY. */
+struct cj_arena {
+    struct cj_arena_chunk* first;
+    struct cj_arena_chunk* current;
+
+    struct cj_allocator* allocator;
+    enum cj_memory_subsystem subsystem;
+    jmp_buf* failure_point;
+};
+
+struct cj_arena_mark {
+    struct cj_arena_chunk* chunk;
+    size_t used;
+};
+
+void cj_init_arena(struct cj_arena* arena, struct cj_allocator* allocator, enum cj_memory_subsystem subsystem);
+
+void* cj_arena_allocate(struct cj_arena* arena, size_t size);
+
+void* cj_arena_reallocate(struct cj_arena* arena, void* pointer, size_t old_size, size_t new_size);
+
+struct cj_arena_mark cj_mark_arena(const struct cj_arena* arena);
+
+void cj_rewind_arena(struct cj_arena* arena, struct cj_arena_mark mark);
+
+void cj_reset_arena(struct cj_arena* arena);
+
+void cj_release_arena(struct cj_arena* arena);
+
+#endif /* CONJOINT_SRC_ARENA_H_ */
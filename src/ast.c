@@ -0,0 +1,215 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "ast.h"
+#include "utf8.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+struct cj_ast_tree_node* cj_init_ast_tree_node(struct cj_arena* arena, char* type) {
+    struct cj_ast_tree_node* node = cj_arena_allocate(arena, sizeof(struct cj_ast_tree_node));
+    if (node == NULL) {
+        return NULL;
+    }
+    node->type = type;
+    node->start = 0;
+    node->end = 0;
+    node->childrens_length = 0;
+    node->childrens_capacity = 0;
+    node->childrens = NULL;
+    return node;
+}
+
+static bool cj_attach_ast_tree_node_children(struct cj_arena* arena, struct cj_ast_tree_node* parent, struct cj_ast_tree_node_children *children) {
+    if (parent->childrens_length == parent->childrens_capacity) {
+        size_t capacity = parent->childrens_capacity > 0 ? parent->childrens_capacity * 2 : 4;
+        struct cj_ast_tree_node_children** childrens = cj_arena_reallocate(arena, parent->childrens,
+            sizeof(struct cj_ast_tree_node_children*) * parent->childrens_capacity,
+            sizeof(struct cj_ast_tree_node_children*) * capacity);
+        if (childrens == NULL) {
+            return false;
+        }
+        parent->childrens = childrens;
+        parent->childrens_capacity = capacity;
+    }
+    parent->childrens[parent->childrens_length++] = children;
+    return true;
+}
+
+static struct cj_ast_tree_node_children* cj_init_ast_tree_node_children(struct cj_arena* arena, enum cj_ast_tree_node_children_type type, char* relation_name) {
+    struct cj_ast_tree_node_children* relation = cj_arena_allocate(arena, sizeof(struct cj_ast_tree_node_children));
+    if (relation == NULL) {
+        return NULL;
+    }
+    relation->type = type;
+    relation->name = relation_name;
+    return relation;
+}
+
+bool cj_add_ast_tree_node_relation(struct cj_arena* arena, struct cj_ast_tree_node* parent, struct cj_ast_tree_node* related, char* relation_name) {
+    struct cj_ast_tree_node_children* relation = cj_init_ast_tree_node_children(arena, NODE_TYPE, relation_name);
+    if (relation == NULL) {
+        return false;
+    }
+    relation->node = related;
+    return cj_attach_ast_tree_node_children(arena, parent, relation);
+}
+
+bool cj_add_ast_tree_node_string_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name, const char* string) {
+    struct cj_ast_tree_node_children* relation = cj_init_ast_tree_node_children(arena, STRING_TYPE, relation_name);
+    if (relation == NULL) {
+        return false;
+    }
+    relation->string = string;
+    return cj_attach_ast_tree_node_children(arena, parent, relation);
+}
+
+bool cj_add_ast_tree_node_character_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name, uint32_t character) {
+    struct cj_ast_tree_node_children* relation = cj_init_ast_tree_node_children(arena, CHARACTER_TYPE, relation_name);
+    if (relation == NULL) {
+        return false;
+    }
+    relation->character = character;
+    return cj_attach_ast_tree_node_children(arena, parent, relation);
+}
+
+bool cj_add_ast_tree_node_boolean_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name, bool boolean) {
+    struct cj_ast_tree_node_children* relation = cj_init_ast_tree_node_children(arena, BOOLEAN_TYPE, relation_name);
+    if (relation == NULL) {
+        return false;
+    }
+    relation->boolean = boolean;
+    return cj_attach_ast_tree_node_children(arena, parent, relation);
+}
+
+bool cj_add_ast_tree_node_number_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name, long double number) {
+    struct cj_ast_tree_node_children* relation = cj_init_ast_tree_node_children(arena, NUMBER_TYPE, relation_name);
+    if (relation == NULL) {
+        return false;
+    }
+    relation->number = number;
+    return cj_attach_ast_tree_node_children(arena, parent, relation);
+}
+
+bool cj_add_ast_tree_node_null_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name) {
+    struct cj_ast_tree_node_children* relation = cj_init_ast_tree_node_children(arena, NULL_TYPE, relation_name);
+    if (relation == NULL) {
+        return false;
+    }
+    return cj_attach_ast_tree_node_children(arena, parent, relation);
+}
+
+struct cj_ast_tree_node_children* cj_find_ast_tree_node_children(const struct cj_ast_tree_node* node, const char* relation_name) {
+    for (size_t i = 0; i < node->childrens_length; i++) {
+        if (strcmp(node->childrens[i]->name, relation_name) == 0) {
+            return node->childrens[i];
+        }
+    }
+    return NULL;
+}
+
+void cj_init_ast_spine(struct cj_ast_spine* spine) {
+    spine->length = 0;
+    spine->capacity = 0;
+    spine->nodes = NULL;
+}
+
+void cj_release_ast_spine(struct cj_ast_spine* spine) {
+    free(spine->nodes);
+    cj_init_ast_spine(spine);
+}
+
+size_t cj_push_ast_spine(struct cj_ast_spine* spine, const struct cj_ast_tree_node* binary_expression) {
+    size_t length = spine->length;
+
+    do {
+        if (spine->length == spine->capacity) {
+            spine->capacity = spine->capacity > 0 ? spine->capacity * 2 : 64;
+            spine->nodes = realloc(spine->nodes, sizeof(const struct cj_ast_tree_node*) * spine->capacity);
+            assert(spine->nodes);
+        }
+
+        spine->nodes[spine->length++] = binary_expression;
+        binary_expression = cj_find_ast_tree_node_children(binary_expression, "left")->node;
+    } while (strcmp(binary_expression->type, "BinaryExpression") == 0);
+
+    return length;
+}
+
+void cj_pop_ast_spine(struct cj_ast_spine* spine, size_t length) {
+    spine->length = length;
+}
+
+void cj_print_ast(const struct cj_ast_tree_node* root, int level) {
+    char* indent = malloc(sizeof(char) * level * 4 + 1);
+    assert(indent);
+    memset(indent, ' ', level * 4);
+    indent[level * 4] = '\0';
+    printf("%s", indent);
+    printf("TYPE: %s\n", root->type);
+    printf("%s", indent);
+    if (root->childrens_length > 0) {
+        printf("CHILDRENS:\n");
+        for (size_t i = 0; i < root->childrens_length; i++) {
+            printf("%s", indent);
+            printf("    %s:", root->childrens[i]->name);
+            switch (root->childrens[i]->type) {
+                case NODE_TYPE:
+                    printf("\n");
+                    cj_print_ast(root->childrens[i]->node, level + 2);
+                    break;
+
+                case STRING_TYPE:
+                    printf(" \"%s\"\n", root->childrens[i]->string);
+                    break;
+
+                case NUMBER_TYPE:
+                    printf(" %Lf\n", root->childrens[i]->number);
+                    break;
+
+                case CHARACTER_TYPE: {
+                    char character[4];
+                    int character_length = cj_encode_utf8(root->childrens[i]->character, character);
+                    printf(" '%.*s'\n", character_length, character);
+                    break;
+                }
+
+                case BOOLEAN_TYPE:
+                    if (root->childrens[i]->boolean) {
+                        printf(" true\n");
+                    } else {
+                        printf(" false\n");
+                    }
+                    break;
+
+                case NULL_TYPE:
+                    printf(" null\n");
+                    break;
+            }
+        }
+    } else {
+        printf("CHILDRENS: ~\n");
+    }
+    free(indent);
+}
@@ -0,0 +1,111 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_AST_H_
+#define CONJOINT_SRC_AST_H_
+
+#include "arena.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* `start` and `end` are offsets into the source content. */
+struct cj_ast_tree_node {
+    char* type;
+
+    size_t start;
+    size_t end;
+
+    size_t childrens_length;
+    size_t childrens_capacity;
+    struct cj_ast_tree_node_children** childrens;
+};
+
+enum cj_ast_tree_node_children_type {
+    NODE_TYPE,
+    STRING_TYPE,
+    NUMBER_TYPE,
+    CHARACTER_TYPE,
+    BOOLEAN_TYPE,
+    NULL_TYPE
+};
+
+struct cj_ast_tree_node_children {
+    enum cj_ast_tree_node_children_type type;
+
+    char* name;
+
+    union {
+        struct cj_ast_tree_node* node;
+        const char* string;
+        long double number;
+        uint32_t character;
+        bool boolean;
+    };
+};
+
+/* Nodes live in the arena they were created in. String values are not
+ * copied, they must outlive the arena. When the arena cannot allocate,
+ * cj_init_ast_tree_node returns NULL and the cj_add_* functions return false
+ * without modifying the parent. */
+struct cj_ast_tree_node* cj_init_ast_tree_node(struct cj_arena* arena, char* type);
+
+bool cj_add_ast_tree_node_relation(struct cj_arena* arena, struct cj_ast_tree_node* parent, struct cj_ast_tree_node* related, char* relation_name);
+
+bool cj_add_ast_tree_node_string_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name, const char* string);
+
+bool cj_add_ast_tree_node_character_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name, uint32_t character);
+
+bool cj_add_ast_tree_node_boolean_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name, bool boolean);
+
+bool cj_add_ast_tree_node_number_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name, long double number);
+
+bool cj_add_ast_tree_node_null_value(struct cj_arena* arena, struct cj_ast_tree_node* parent, char* relation_name);
+
+/* First children with the given relation name, or NULL. */
+struct cj_ast_tree_node_children* cj_find_ast_tree_node_children(const struct cj_ast_tree_node* node, const char* relation_name);
+
+/* Stack of the binary expressions of left-associative chains such as
+ * `1 + 1 + ... + 1`, whose trees are as deep as the chain is long. Passes
+ * walk a chain through it, from the innermost expression out, so that they
+ * only recurse as deep as the expression is nested. Nested chains are pushed
+ * above the one being walked and popped back with cj_pop_ast_spine. */
+struct cj_ast_spine {
+    size_t length;
+    size_t capacity;
+    const struct cj_ast_tree_node** nodes;
+};
+
+void cj_init_ast_spine(struct cj_ast_spine* spine);
+
+void cj_release_ast_spine(struct cj_ast_spine* spine);
+
+/* Pushes a binary expression, then its left operand as long as that is a
+ * binary expression too, so the innermost one ends on top. Returns the
+ * length to pop back to. */
+size_t cj_push_ast_spine(struct cj_ast_spine* spine, const struct cj_ast_tree_node* binary_expression);
+
+void cj_pop_ast_spine(struct cj_ast_spine* spine, size_t length);
+
+void cj_print_ast(const struct cj_ast_tree_node* root, int level);
+
+#endif /* CONJOINT_SRC_AST_H_ */
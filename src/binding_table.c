@@ -0,0 +1,101 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "binding_table.h"
+
+#include <stdint.h>
+#include <string.h>
+
+static uint32_t cj_hash_binding_name(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (; *name; name++) {
+        hash = (hash ^ (unsigned char) *name) * 16777619u;
+    }
+    return hash;
+}
+
+static struct cj_binding* cj_find_binding_slot(struct cj_binding* bindings, size_t capacity, const char* name) {
+    size_t slot = cj_hash_binding_name(name) & (capacity - 1);
+    while (bindings[slot].name != NULL && strcmp(bindings[slot].name, name) != 0) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return &bindings[slot];
+}
+
+void cj_init_binding_table(struct cj_binding_table* table, struct cj_allocator* allocator) {
+    table->allocator = allocator;
+    table->length = 0;
+    table->capacity = 0;
+    table->bindings = NULL;
+}
+
+void cj_clear_binding_table(struct cj_binding_table* table) {
+    if (table->bindings != NULL) {
+        memset(table->bindings, 0, sizeof(struct cj_binding) * table->capacity);
+    }
+    table->length = 0;
+}
+
+void cj_release_binding_table(struct cj_binding_table* table) {
+    cj_deallocate(table->allocator, GENERAL_MEMORY, table->bindings, sizeof(struct cj_binding) * table->capacity);
+    cj_init_binding_table(table, table->allocator);
+}
+
+const struct cj_binding* cj_find_binding(const struct cj_binding_table* table, const char* name) {
+    if (table->capacity == 0) {
+        return NULL;
+    }
+
+    struct cj_binding* binding = cj_find_binding_slot(table->bindings, table->capacity, name);
+    return binding->name != NULL ? binding : NULL;
+}
+
+enum cj_binding_status cj_add_binding(struct cj_binding_table* table, enum cj_binding_type type, const char* name, size_t index) {
+    if ((table->length + 1) * 2 > table->capacity) {
+        size_t capacity = table->capacity > 0 ? table->capacity * 2 : 64;
+        struct cj_binding* bindings = cj_allocate(table->allocator, GENERAL_MEMORY, sizeof(struct cj_binding) * capacity);
+        if (bindings == NULL) {
+            return BINDING_OUT_OF_MEMORY;
+        }
+        memset(bindings, 0, sizeof(struct cj_binding) * capacity);
+
+        for (size_t i = 0; i < table->capacity; i++) {
+            if (table->bindings[i].name != NULL) {
+                *cj_find_binding_slot(bindings, capacity, table->bindings[i].name) = table->bindings[i];
+            }
+        }
+
+        cj_deallocate(table->allocator, GENERAL_MEMORY, table->bindings, sizeof(struct cj_binding) * table->capacity);
+        table->bindings = bindings;
+        table->capacity = capacity;
+    }
+
+    struct cj_binding* binding = cj_find_binding_slot(table->bindings, table->capacity, name);
+    if (binding->name != NULL) {
+        return BINDING_ALREADY_BOUND;
+    }
+
+    binding->type = type;
+    binding->name = name;
+    binding->index = index;
+    table->length++;
+    return BINDING_ADDED;
+}
@@ -0,0 +1,66 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_BINDING_TABLE_H_
+#define CONJOINT_SRC_BINDING_TABLE_H_
+
+#include "allocator.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+enum cj_binding_type {
+    VARIABLE_BINDING,
+    NATIVE_BINDING
+};
+
+enum cj_binding_status {
+    BINDING_ADDED,
+    BINDING_ALREADY_BOUND,
+    BINDING_OUT_OF_MEMORY
+};
+
+/* What a name refers to: the meaning of `index` is up to the backend. */
+struct cj_binding {
+    enum cj_binding_type type;
+    const char* name;
+    size_t index;
+};
+
+struct cj_binding_table {
+    struct cj_allocator* allocator;
+    size_t length;
+    size_t capacity;
+    struct cj_binding* bindings;
+};
+
+void cj_init_binding_table(struct cj_binding_table* table, struct cj_allocator* allocator);
+
+void cj_clear_binding_table(struct cj_binding_table* table);
+
+void cj_release_binding_table(struct cj_binding_table* table);
+
+const struct cj_binding* cj_find_binding(const struct cj_binding_table* table, const char* name);
+
+/* The table is left as it was unless the binding is added. */
+enum cj_binding_status cj_add_binding(struct cj_binding_table* table, enum cj_binding_type type, const char* name, size_t index);
+
+#endif /* CONJOINT_SRC_BINDING_TABLE_H_ */
@@ -0,0 +1,188 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "bytecode.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+static char* opcode_strings[] = {
+    "LOAD_CONSTANT",
+    "MOVE",
+    "CALL_NATIVE",
+    "BITWISE_OR",
+    "BITWISE_XOR",
+    "BITWISE_AND",
+    "EQUAL",
+    "NOT_EQUAL",
+    "LESS",
+    "GREATER",
+    "LEFT_SHIFT",
+    "RIGHT_SHIFT",
+    "UNSIGNED_RIGHT_SHIFT",
+    "ADD",
+    "SUBTRACT",
+    "MULTIPLY",
+    "DIVIDE",
+    "REMAINDER",
+    "NEGATE",
+    "BITWISE_NOT",
+    "NOT",
+    "JUMP_IF_FALSE",
+    "JUMP_IF_TRUE",
+    "HALT"
+};
+
+static size_t opcode_operands_lengths[] = {
+    1,
+    1,
+    3,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    2,
+    1,
+    1,
+    1,
+    1,
+    1,
+    0
+};
+
+void cj_init_bytecode_program(struct cj_bytecode_program* program, struct cj_allocator* allocator) {
+    program->code_length = 0;
+    program->code_capacity = 0;
+    program->code = NULL;
+    program->constants_length = 0;
+    program->constants_capacity = 0;
+    program->constants = NULL;
+    program->natives_length = 0;
+    program->natives_capacity = 0;
+    program->natives = NULL;
+    program->registers_length = 0;
+    program->out_of_memory = false;
+    cj_init_arena(&program->arena, allocator, GENERAL_MEMORY);
+}
+
+void cj_reset_bytecode_program(struct cj_bytecode_program* program) {
+    program->code_length = 0;
+    program->constants_length = 0;
+    program->natives_length = 0;
+    program->registers_length = 0;
+    program->out_of_memory = false;
+    cj_reset_arena(&program->arena);
+}
+
+void cj_release_bytecode_program(struct cj_bytecode_program* program) {
+    struct cj_allocator* allocator = program->arena.allocator;
+    cj_deallocate(allocator, GENERAL_MEMORY, program->code, sizeof(uint32_t) * program->code_capacity);
+    cj_deallocate(allocator, GENERAL_MEMORY, program->constants, sizeof(struct cj_value) * program->constants_capacity);
+    cj_deallocate(allocator, GENERAL_MEMORY, program->natives, sizeof(struct cj_native_export*) * program->natives_capacity);
+    cj_release_arena(&program->arena);
+    cj_init_bytecode_program(program, allocator);
+}
+
+static bool cj_grow_bytecode_array(struct cj_bytecode_program* program, void** items, size_t* capacity, size_t length, size_t item_size, size_t initial_capacity) {
+    if (length < *capacity) {
+        return true;
+    }
+
+    size_t grown_capacity = *capacity > 0 ? *capacity * 2 : initial_capacity;
+    void* grown = cj_reallocate(program->arena.allocator, GENERAL_MEMORY, *items, item_size * *capacity, item_size * grown_capacity);
+    if (grown == NULL) {
+        program->out_of_memory = true;
+        return false;
+    }
+
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+size_t cj_emit_bytecode(struct cj_bytecode_program* program, uint32_t word) {
+    if (!cj_grow_bytecode_array(program, (void**) &program->code, &program->code_capacity, program->code_length, sizeof(uint32_t), 64)) {
+        return program->code_length;
+    }
+    program->code[program->code_length] = word;
+    return program->code_length++;
+}
+
+size_t cj_add_bytecode_constant(struct cj_bytecode_program* program, struct cj_value value) {
+    if (!cj_grow_bytecode_array(program, (void**) &program->constants, &program->constants_capacity, program->constants_length, sizeof(struct cj_value), 16)) {
+        return 0;
+    }
+    program->constants[program->constants_length] = value;
+    return program->constants_length++;
+}
+
+size_t cj_add_bytecode_native(struct cj_bytecode_program* program, const struct cj_native_export* native) {
+    for (size_t i = 0; i < program->natives_length; i++) {
+        if (program->natives[i] == native) {
+            return i;
+        }
+    }
+
+    if (!cj_grow_bytecode_array(program, (void**) &program->natives, &program->natives_capacity, program->natives_length, sizeof(struct cj_native_export*), 4)) {
+        return 0;
+    }
+    program->natives[program->natives_length] = native;
+    return program->natives_length++;
+}
+
+void cj_print_bytecode_program(const struct cj_bytecode_program* program) {
+    printf("REGISTERS: %zu\n", program->registers_length);
+
+    printf("CONSTANTS:\n");
+    for (size_t i = 0; i < program->constants_length; i++) {
+        printf("    %zu: ", i);
+        cj_print_value(program->constants[i], stdout);
+        printf("\n");
+    }
+
+    printf("CODE:\n");
+    for (size_t i = 0; i < program->code_length;) {
+        uint32_t instruction = program->code[i];
+        enum cj_opcode opcode = cj_instruction_opcode(instruction);
+        printf("    %04zu %-20s r%u", i, opcode_strings[opcode], cj_instruction_destination(instruction));
+
+        for (size_t j = 1; j <= opcode_operands_lengths[opcode]; j++) {
+            printf(" %u", program->code[i + j]);
+        }
+
+        if (opcode == OP_CALL_NATIVE) {
+            printf(" ; %s", program->natives[program->code[i + 1]]->name);
+        }
+
+        printf("\n");
+        i += 1 + opcode_operands_lengths[opcode];
+    }
+}
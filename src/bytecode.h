@@ -0,0 +1,115 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_BYTECODE_H_
+#define CONJOINT_SRC_BYTECODE_H_
+
+#include "arena.h"
+#include "native_module.h"
+#include "value.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Every instruction starts with a word holding the opcode in the low 8 bits
+ * and the destination register in the upper 24 bits, followed by the
+ * operand words listed next to each opcode. */
+enum cj_opcode {
+    OP_LOAD_CONSTANT,   /* constant */
+    OP_MOVE,            /* source register */
+    OP_CALL_NATIVE,     /* native, first argument register, arguments count */
+    OP_BITWISE_OR,      /* left register, right register */
+    OP_BITWISE_XOR,     /* left register, right register */
+    OP_BITWISE_AND,     /* left register, right register */
+    OP_EQUAL,           /* left register, right register */
+    OP_NOT_EQUAL,       /* left register, right register */
+    OP_LESS,            /* left register, right register */
+    OP_GREATER,         /* left register, right register */
+    OP_LEFT_SHIFT,      /* left register, right register */
+    OP_RIGHT_SHIFT,     /* left register, right register */
+    OP_UNSIGNED_RIGHT_SHIFT, /* left register, right register */
+    OP_ADD,             /* left register, right register */
+    OP_SUBTRACT,        /* left register, right register */
+    OP_MULTIPLY,        /* left register, right register */
+    OP_DIVIDE,          /* left register, right register */
+    OP_REMAINDER,       /* left register, right register */
+    OP_NEGATE,          /* argument register */
+    OP_BITWISE_NOT,     /* argument register */
+    OP_NOT,             /* argument register */
+    OP_JUMP_IF_FALSE,   /* target; the destination is the tested register */
+    OP_JUMP_IF_TRUE,    /* target; the destination is the tested register */
+    OP_HALT
+};
+
+#define CJ_MAXIMUM_OPERAND 0xFFFFFF
+
+#define cj_encode_instruction(opcode, destination) \
+    ((uint32_t) (opcode) | ((uint32_t) (destination) << 8))
+
+#define cj_instruction_opcode(instruction) \
+    ((instruction) & 0xFF)
+
+#define cj_instruction_destination(instruction) \
+    ((instruction) >> 8)
+
+struct cj_bytecode_program {
+    size_t code_length;
+    size_t code_capacity;
+    uint32_t* code;
+
+    size_t constants_length;
+    size_t constants_capacity;
+    struct cj_value* constants;
+
+    size_t natives_length;
+    size_t natives_capacity;
+    const struct cj_native_export** natives;
+
+    size_t registers_length;
+
+    /* Set when the code, the constants or the natives could not grow. What
+     * was added since is dropped and the program must not be run. */
+    bool out_of_memory;
+
+    /* Storage for string constants. */
+    struct cj_arena arena;
+};
+
+/* The code, the constants and their strings are allocated from
+ * `allocator`. */
+void cj_init_bytecode_program(struct cj_bytecode_program* program, struct cj_allocator* allocator);
+
+void cj_reset_bytecode_program(struct cj_bytecode_program* program);
+
+void cj_release_bytecode_program(struct cj_bytecode_program* program);
+
+/* These return the position of what they add, which is meaningless once
+ * `out_of_memory` is set. */
+size_t cj_emit_bytecode(struct cj_bytecode_program* program, uint32_t word);
+
+size_t cj_add_bytecode_constant(struct cj_bytecode_program* program, struct cj_value value);
+
+size_t cj_add_bytecode_native(struct cj_bytecode_program* program, const struct cj_native_export* native);
+
+void cj_print_bytecode_program(const struct cj_bytecode_program* program);
+
+#endif /* CONJOINT_SRC_BYTECODE_H_ */
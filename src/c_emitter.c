@@ -0,0 +1,899 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "c_emitter.h"
+#include "operator.h"
+#include "standard_module.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Runtime support of the generated programs. Printing matches
+ * cj_format_value so both backends produce the same output. */
+static const char c_prelude[] =
+    "#include <math.h>\n"
+    "#include <stdbool.h>\n"
+    "#include <stddef.h>\n"
+    "#include <stdint.h>\n"
+    "#include <stdio.h>\n"
+    "#include <string.h>\n"
+    "\n"
+    "typedef struct {\n"
+    "    size_t length;\n"
+    "    const char* data;\n"
+    "} cj_string;\n"
+    "\n"
+    "static inline int32_t cj_to_int32(double number) {\n"
+    "    if (!isfinite(number)) {\n"
+    "        return 0;\n"
+    "    }\n"
+    "    double modulo = fmod(trunc(number), 4294967296.0);\n"
+    "    if (modulo < 0) {\n"
+    "        modulo += 4294967296.0;\n"
+    "    }\n"
+    "    return (int32_t) (uint32_t) modulo;\n"
+    "}\n"
+    "\n"
+    "static inline bool cj_equal_value(double left, double right) {\n"
+    "    return left == right;\n"
+    "}\n"
+    "\n"
+    "static inline bool cj_equal_string(cj_string left, cj_string right) {\n"
+    "    return left.length == right.length && memcmp(left.data, right.data, left.length) == 0;\n"
+    "}\n"
+    "\n"
+    "static inline int cj_io_print_null(int value) {\n"
+    "    (void) value;\n"
+    "    fputs(\"null\", stdout);\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "static inline int cj_io_print_boolean(bool value) {\n"
+    "    fputs(value ? \"true\" : \"false\", stdout);\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "static inline int cj_io_print_number(double value) {\n"
+    "    if (value == floor(value) && fabs(value) < 1e15) {\n"
+    "        printf(\"%.0f\", value);\n"
+    "    } else {\n"
+    "        printf(\"%.17g\", value);\n"
+    "    }\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "static inline int cj_io_print_character(uint32_t value) {\n"
+    "    if (value < 0x80) {\n"
+    "        putchar(value);\n"
+    "    } else if (value < 0x800) {\n"
+    "        putchar(0xC0 | (value >> 6));\n"
+    "        putchar(0x80 | (value & 0x3F));\n"
+    "    } else if (value < 0x10000) {\n"
+    "        putchar(0xE0 | (value >> 12));\n"
+    "        putchar(0x80 | ((value >> 6) & 0x3F));\n"
+    "        putchar(0x80 | (value & 0x3F));\n"
+    "    } else {\n"
+    "        putchar(0xF0 | (value >> 18));\n"
+    "        putchar(0x80 | ((value >> 12) & 0x3F));\n"
+    "        putchar(0x80 | ((value >> 6) & 0x3F));\n"
+    "        putchar(0x80 | (value & 0x3F));\n"
+    "    }\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "static inline int cj_io_print_string(cj_string value) {\n"
+    "    fwrite(value.data, 1, value.length, stdout);\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "#define CJ_DEFINE_TYPE(name, type, equal) \\\n"
+    "    typedef struct { \\\n"
+    "        bool present; \\\n"
+    "        type value; \\\n"
+    "    } cj_optional_##name; \\\n"
+    "    static inline bool cj_equal_optional_##name(cj_optional_##name left, cj_optional_##name right) { \\\n"
+    "        return left.present == right.present && (!left.present || equal(left.value, right.value)); \\\n"
+    "    } \\\n"
+    "    static inline int cj_io_printLine_##name(type value) { \\\n"
+    "        cj_io_print_##name(value); \\\n"
+    "        putchar('\\n'); \\\n"
+    "        return 0; \\\n"
+    "    } \\\n"
+    "    static inline int cj_io_print_optional_##name(cj_optional_##name value) { \\\n"
+    "        return value.present ? cj_io_print_##name(value.value) : cj_io_print_null(0); \\\n"
+    "    } \\\n"
+    "    static inline int cj_io_printLine_optional_##name(cj_optional_##name value) { \\\n"
+    "        cj_io_print_optional_##name(value); \\\n"
+    "        putchar('\\n'); \\\n"
+    "        return 0; \\\n"
+    "    }\n"
+    "\n"
+    "CJ_DEFINE_TYPE(boolean, bool, cj_equal_value)\n"
+    "CJ_DEFINE_TYPE(number, double, cj_equal_value)\n"
+    "CJ_DEFINE_TYPE(character, uint32_t, cj_equal_value)\n"
+    "CJ_DEFINE_TYPE(string, cj_string, cj_equal_string)\n"
+    "\n"
+    "static inline int cj_io_printLine_null(int value) {\n"
+    "    cj_io_print_null(value);\n"
+    "    putchar('\\n');\n"
+    "    return 0;\n"
+    "}\n";
+
+static const char* type_names[] = {
+    "Null",
+    "Boolean",
+    "Number",
+    "Character",
+    "String"
+};
+
+static const char* type_suffixes[] = {
+    "null",
+    "boolean",
+    "number",
+    "character",
+    "string"
+};
+
+static const char* c_type_names[] = {
+    "int",
+    "bool",
+    "double",
+    "uint32_t",
+    "cj_string"
+};
+
+static bool cj_grow_c_table(struct cj_emission_process* process, void** items, size_t* capacity, size_t length, size_t item_size, size_t initial_capacity) {
+    if (length < *capacity) {
+        return true;
+    }
+
+    size_t grown_capacity = *capacity > 0 ? *capacity * 2 : initial_capacity;
+    void* grown = cj_reallocate(process->allocator, GENERAL_MEMORY, *items, item_size * *capacity, item_size * grown_capacity);
+    if (grown == NULL) {
+        process->out_of_memory = true;
+        return false;
+    }
+
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+/* Grows `items` to hold at least `length` bytes, starting with `initial`. */
+static bool cj_reserve_c_buffer(struct cj_emission_process* process, char** items, size_t* capacity, size_t length, size_t initial) {
+    if (length <= *capacity) {
+        return true;
+    }
+
+    size_t grown_capacity = *capacity > 0 ? *capacity : initial;
+    while (length > grown_capacity) {
+        grown_capacity *= 2;
+    }
+
+    char* grown = cj_reallocate(process->allocator, GENERAL_MEMORY, *items, *capacity, grown_capacity);
+    if (grown == NULL) {
+        process->out_of_memory = true;
+        return false;
+    }
+
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+static bool cj_reserve_c_code(struct cj_emission_process* process, size_t length) {
+    return cj_reserve_c_buffer(process, &process->code, &process->code_capacity, process->code_length + length + 1, 4096);
+}
+
+static void cj_append_c_code(struct cj_emission_process* process, const char* format, ...) {
+    va_list arguments;
+
+    va_start(arguments, format);
+    int length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+
+    if (!cj_reserve_c_code(process, length)) {
+        return;
+    }
+
+    va_start(arguments, format);
+    vsnprintf(process->code + process->code_length, length + 1, format, arguments);
+    va_end(arguments);
+
+    process->code_length += length;
+}
+
+static void cj_insert_c_code_length(struct cj_emission_process* process, size_t position, const char* text, size_t length) {
+    if (!cj_reserve_c_code(process, length)) {
+        return;
+    }
+    memmove(process->code + position + length, process->code + position, process->code_length - position);
+    memcpy(process->code + position, text, length);
+    process->code_length += length;
+}
+
+static void cj_insert_c_code(struct cj_emission_process* process, size_t position, const char* text) {
+    size_t length = strlen(text);
+
+    if (position != process->prefixes_position) {
+        cj_insert_c_code_length(process, position, text, length);
+        return;
+    }
+
+    if (!cj_reserve_c_buffer(process, &process->prefixes, &process->prefixes_capacity, process->prefixes_length + length, 256)) {
+        return;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        process->prefixes[process->prefixes_length++] = text[length - 1 - i];
+    }
+}
+
+/* Starts deferring the code inserted at the current end, returns what
+ * cj_insert_c_prefixes needs to restore the previous state. */
+static size_t cj_defer_c_prefixes(struct cj_emission_process* process, size_t* position) {
+    *position = process->prefixes_position;
+    process->prefixes_position = process->code_length;
+    return process->prefixes_length;
+}
+
+/* Inserts the code deferred since cj_defer_c_prefixes, which stays deferred
+ * if the enclosing chain starts at the same position. */
+static void cj_insert_c_prefixes(struct cj_emission_process* process, size_t prefixes_length, size_t position) {
+    size_t start = process->prefixes_position;
+    process->prefixes_position = position;
+
+    if (start == position || process->prefixes_length == prefixes_length) {
+        return;
+    }
+
+    char* prefixes = process->prefixes + prefixes_length;
+    size_t length = process->prefixes_length - prefixes_length;
+
+    for (size_t i = 0; i < length / 2; i++) {
+        char character = prefixes[i];
+        prefixes[i] = prefixes[length - 1 - i];
+        prefixes[length - 1 - i] = character;
+    }
+
+    cj_insert_c_code_length(process, start, prefixes, length);
+    process->prefixes_length = prefixes_length;
+}
+
+/* Surrounds the code between `start` and `end`, returns the new end. */
+static size_t cj_wrap_c_code(struct cj_emission_process* process, size_t start, size_t end, const char* prefix, const char* suffix) {
+    size_t code_length = process->code_length;
+    cj_insert_c_code(process, end, suffix);
+    cj_insert_c_code(process, start, prefix);
+    return end + process->code_length - code_length;
+}
+
+static const char* cj_format_static_type(struct cj_static_type type, char buffer[16]) {
+    snprintf(buffer, 16, "%s%s", type_names[type.value_type], type.optional ? "?" : "");
+    return buffer;
+}
+
+static const char* cj_format_c_type(struct cj_static_type type, char buffer[32]) {
+    if (type.optional) {
+        snprintf(buffer, 32, "cj_optional_%s", type_suffixes[type.value_type]);
+        return buffer;
+    }
+    return c_type_names[type.value_type];
+}
+
+static bool cj_check_static_types_equal(struct cj_static_type left, struct cj_static_type right) {
+    return left.value_type == right.value_type && left.optional == right.optional;
+}
+
+/* Rewrites the code between `start` and `end` so it yields a `to` value,
+ * which is possible when `to` is the optional version of `from` or `from`
+ * is null. Returns the new end, or 0 if there is no conversion. */
+static size_t cj_convert_c_code(struct cj_emission_process* process, size_t start, size_t end, struct cj_static_type from, struct cj_static_type to) {
+    char prefix[64];
+    char c_type[32];
+
+    if (cj_check_static_types_equal(from, to)) {
+        return end;
+    } else if (!to.optional || from.optional) {
+        return 0;
+    } else if (from.value_type == to.value_type) {
+        snprintf(prefix, sizeof(prefix), "((%s) {true, ", cj_format_c_type(to, c_type));
+        return cj_wrap_c_code(process, start, end, prefix, "})");
+    } else if (from.value_type == NULL_VALUE) {
+        snprintf(prefix, sizeof(prefix), "), (%s) {.present = false})", cj_format_c_type(to, c_type));
+        return cj_wrap_c_code(process, start, end, "((void) (", prefix);
+    }
+
+    return 0;
+}
+
+static const char* cj_get_identifier_name(const struct cj_ast_tree_node* identifier) {
+    return cj_find_ast_tree_node_children(identifier, "value")->string;
+}
+
+static bool cj_bind_emitted_name(struct cj_emission_process* process, const struct cj_ast_tree_node* node, enum cj_binding_type type, const char* name, size_t index) {
+    enum cj_binding_status status = cj_add_binding(&process->bindings, type, name, index);
+
+    if (status == BINDING_ALREADY_BOUND) {
+        cj_report_diagnostic(&process->diagnostics, node->start, "`%s` is already declared", name);
+    } else if (status == BINDING_OUT_OF_MEMORY) {
+        process->out_of_memory = true;
+    }
+    return status == BINDING_ADDED;
+}
+
+static void cj_emit_c_string(struct cj_emission_process* process, const char* string) {
+    size_t length = strlen(string);
+    cj_append_c_code(process, "((cj_string) {%zu, \"", length);
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char character = string[i];
+
+        if (character >= 0x20 && character < 0x7F && character != '"' && character != '\\' && character != '?') {
+            cj_append_c_code(process, "%c", character);
+        } else {
+            cj_append_c_code(process, "\\%03o", character);
+        }
+    }
+
+    cj_append_c_code(process, "\"})");
+}
+
+static void cj_emit_c_number(struct cj_emission_process* process, double number) {
+    if (isnan(number)) {
+        cj_append_c_code(process, "NAN");
+    } else if (isinf(number)) {
+        cj_append_c_code(process, number < 0 ? "(-INFINITY)" : "INFINITY");
+    } else {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.17g", number);
+        const char* suffix = strpbrk(buffer, ".e") != NULL ? "" : ".0";
+        cj_append_c_code(process, signbit(number) ? "(%s%s)" : "%s%s", buffer, suffix);
+    }
+}
+
+static bool cj_emit_c_literal(struct cj_emission_process* process, const struct cj_ast_tree_node* literal, struct cj_static_type* type) {
+    const struct cj_ast_tree_node_children* value = cj_find_ast_tree_node_children(literal, "value");
+    type->optional = false;
+
+    switch (value->type) {
+        case STRING_TYPE:
+            cj_emit_c_string(process, value->string);
+            type->value_type = STRING_VALUE;
+            break;
+
+        case NUMBER_TYPE:
+            cj_emit_c_number(process, (double) value->number);
+            type->value_type = NUMBER_VALUE;
+            break;
+
+        case CHARACTER_TYPE:
+            cj_append_c_code(process, "((uint32_t) %lu)", (unsigned long) value->character);
+            type->value_type = CHARACTER_VALUE;
+            break;
+
+        case BOOLEAN_TYPE:
+            cj_append_c_code(process, value->boolean ? "true" : "false");
+            type->value_type = BOOLEAN_VALUE;
+            break;
+
+        default:
+            cj_append_c_code(process, "0");
+            type->value_type = NULL_VALUE;
+            break;
+    }
+
+    return true;
+}
+
+static bool cj_emit_c_expression(struct cj_emission_process* process, const struct cj_ast_tree_node* expression, struct cj_static_type* type);
+
+/* Natives are called through per argument type wrappers defined in the
+ * prelude, e.g. `cj_io_printLine_number`. They all return null. */
+static bool cj_emit_c_call_expression(struct cj_emission_process* process, const struct cj_ast_tree_node* call_expression, struct cj_static_type* type) {
+    const struct cj_ast_tree_node* callee = cj_find_ast_tree_node_children(call_expression, "callee")->node;
+    const struct cj_binding* binding = NULL;
+
+    if (strcmp(callee->type, "Identifier") == 0) {
+        binding = cj_find_binding(&process->bindings, cj_get_identifier_name(callee));
+
+        if (binding == NULL) {
+            cj_report_diagnostic(&process->diagnostics, callee->start, "`%s` is not declared", cj_get_identifier_name(callee));
+            return false;
+        }
+    }
+
+    if (binding == NULL || binding->type != NATIVE_BINDING) {
+        cj_report_diagnostic(&process->diagnostics, callee->start, "expression is not callable");
+        return false;
+    }
+
+    const struct cj_emitted_native* native = &process->natives[binding->index];
+    size_t arguments_length = 0;
+
+    for (size_t i = 0; i < call_expression->childrens_length; i++) {
+        if (strcmp(call_expression->childrens[i]->name, "argument") == 0) {
+            arguments_length++;
+        }
+    }
+
+    if (arguments_length != native->export->arity) {
+        cj_report_diagnostic(&process->diagnostics, call_expression->start, "`%s` expects %zu arguments, %zu given", native->export->name, native->export->arity, arguments_length);
+        return false;
+    }
+
+    size_t start = process->code_length;
+    char name[64];
+    size_t name_length = (size_t) snprintf(name, sizeof(name), "cj_%s_%s", native->module->name, native->export->name);
+
+    cj_append_c_code(process, "(");
+
+    for (size_t i = 0, j = 0; i < call_expression->childrens_length; i++) {
+        if (strcmp(call_expression->childrens[i]->name, "argument") != 0) {
+            continue;
+        }
+
+        struct cj_static_type argument_type;
+        if (j++ > 0) {
+            cj_append_c_code(process, ", ");
+        }
+        if (!cj_emit_c_expression(process, call_expression->childrens[i]->node, &argument_type)) {
+            return false;
+        }
+
+        if (name_length < sizeof(name)) {
+            name_length += snprintf(name + name_length, sizeof(name) - name_length, "_%s%s", argument_type.optional ? "optional_" : "", type_suffixes[argument_type.value_type]);
+        }
+    }
+
+    cj_append_c_code(process, ")");
+    cj_insert_c_code(process, start, name);
+
+    type->value_type = NULL_VALUE;
+    type->optional = false;
+    return true;
+}
+
+/* Values of different types are never equal, one that can be null is
+ * compared with the other after both are made optional. */
+static bool cj_emit_c_equality(struct cj_emission_process* process, size_t left_start, size_t right_start, enum cj_operator operator, struct cj_static_type left, struct cj_static_type right) {
+    struct cj_static_type common = left;
+
+    if (cj_check_static_types_equal(left, right)) {
+        /* Nothing to convert. */
+    } else if (left.value_type == right.value_type || right.value_type == NULL_VALUE) {
+        common.value_type = left.value_type;
+        common.optional = true;
+    } else if (left.value_type == NULL_VALUE) {
+        common.value_type = right.value_type;
+        common.optional = true;
+    } else {
+        cj_insert_c_code(process, right_start, "), (void) (");
+        cj_wrap_c_code(process, left_start, process->code_length, "((void) (", operator == EQUAL_OPERATOR ? "), false)" : "), true)");
+        return true;
+    }
+
+    right_start = cj_convert_c_code(process, left_start, right_start, left, common);
+    cj_convert_c_code(process, right_start, process->code_length, right, common);
+
+    char prefix[48];
+    if (common.optional) {
+        snprintf(prefix, sizeof(prefix), "cj_equal_optional_%s(", type_suffixes[common.value_type]);
+        cj_insert_c_code(process, right_start, ", ");
+        cj_wrap_c_code(process, left_start, process->code_length, prefix, ")");
+    } else if (common.value_type == STRING_VALUE) {
+        cj_insert_c_code(process, right_start, ", ");
+        cj_wrap_c_code(process, left_start, process->code_length, "cj_equal_string(", ")");
+    } else if (common.value_type == NULL_VALUE) {
+        cj_insert_c_code(process, right_start, "), (void) (");
+        cj_wrap_c_code(process, left_start, process->code_length, "((void) (", "), true)");
+    } else {
+        cj_insert_c_code(process, right_start, " == ");
+        cj_wrap_c_code(process, left_start, process->code_length, "(", ")");
+    }
+
+    if (operator == NOT_EQUAL_OPERATOR) {
+        cj_wrap_c_code(process, left_start, process->code_length, "(!", ")");
+    }
+    return true;
+}
+
+/* Combines the emitted operands of `binary_expression`, the left one from
+ * `left_start` and the right one from `right_start`. Their types were
+ * checked by cj_check_types. */
+static bool cj_emit_c_binary_operation(struct cj_emission_process* process, const struct cj_ast_tree_node* binary_expression, size_t left_start, size_t right_start, struct cj_static_type left, struct cj_static_type right, struct cj_static_type* type) {
+    const char* symbol = cj_find_ast_tree_node_children(binary_expression, "operator")->string;
+    enum cj_operator operator = cj_find_binary_operator(symbol, strlen(symbol));
+
+    type->optional = false;
+
+    if (operator == EQUAL_OPERATOR || operator == NOT_EQUAL_OPERATOR) {
+        type->value_type = BOOLEAN_VALUE;
+        return cj_emit_c_equality(process, left_start, right_start, operator, left, right);
+    }
+
+    const char* prefix = "(";
+    const char* infix = "";
+    const char* suffix = ")";
+
+    switch (operator) {
+        case LOGICAL_OR_OPERATOR:
+        case LOGICAL_AND_OPERATOR:
+            type->value_type = BOOLEAN_VALUE;
+            infix = operator == LOGICAL_OR_OPERATOR ? " || " : " && ";
+            break;
+
+        case LESS_OPERATOR:
+        case GREATER_OPERATOR:
+            type->value_type = BOOLEAN_VALUE;
+            infix = operator == LESS_OPERATOR ? " < " : " > ";
+            break;
+
+        default:
+            type->value_type = NUMBER_VALUE;
+            break;
+    }
+
+    switch (operator) {
+        case BITWISE_OR_OPERATOR:
+        case BITWISE_XOR_OPERATOR:
+        case BITWISE_AND_OPERATOR:
+            prefix = "((double) (cj_to_int32(";
+            infix = operator == BITWISE_OR_OPERATOR ? ") | cj_to_int32(" : operator == BITWISE_XOR_OPERATOR ? ") ^ cj_to_int32(" : ") & cj_to_int32(";
+            suffix = ")))";
+            break;
+
+        case LEFT_SHIFT_OPERATOR:
+            prefix = "((double) (int32_t) ((uint32_t) cj_to_int32(";
+            infix = ") << (cj_to_int32(";
+            suffix = ") & 31)))";
+            break;
+
+        case RIGHT_SHIFT_OPERATOR:
+            prefix = "((double) (cj_to_int32(";
+            infix = ") >> (cj_to_int32(";
+            suffix = ") & 31)))";
+            break;
+
+        case UNSIGNED_RIGHT_SHIFT_OPERATOR:
+            prefix = "((double) ((uint32_t) cj_to_int32(";
+            infix = ") >> (cj_to_int32(";
+            suffix = ") & 31)))";
+            break;
+
+        case ADD_OPERATOR:
+            infix = " + ";
+            break;
+
+        case SUBTRACT_OPERATOR:
+            infix = " - ";
+            break;
+
+        case MULTIPLY_OPERATOR:
+            infix = " * ";
+            break;
+
+        case DIVIDE_OPERATOR:
+            infix = " / ";
+            break;
+
+        case REMAINDER_OPERATOR:
+            prefix = "fmod(";
+            infix = ", ";
+            break;
+
+        default:
+            break;
+    }
+
+    cj_insert_c_code(process, right_start, infix);
+    cj_wrap_c_code(process, left_start, process->code_length, prefix, suffix);
+    return true;
+}
+
+/* A chain is emitted from its innermost expression out, each one wrapping
+ * the code of the previous one as its left operand. The code those wraps
+ * insert before the chain is deferred until the end, so that the chain is
+ * not moved once per expression. */
+static bool cj_emit_c_binary_expression(struct cj_emission_process* process, const struct cj_ast_tree_node* binary_expression, struct cj_static_type* type) {
+    size_t spine_length = cj_push_ast_spine(&process->spine, binary_expression);
+    const struct cj_ast_tree_node* innermost = process->spine.nodes[process->spine.length - 1];
+    size_t left_start = process->code_length;
+    size_t prefixes_position;
+    size_t prefixes_length = cj_defer_c_prefixes(process, &prefixes_position);
+    bool emitted = cj_emit_c_expression(process, cj_find_ast_tree_node_children(innermost, "left")->node, type);
+
+    for (size_t i = process->spine.length; emitted && i-- > spine_length;) {
+        const struct cj_ast_tree_node* node = process->spine.nodes[i];
+        struct cj_static_type left = *type;
+        struct cj_static_type right;
+        size_t right_start = process->code_length;
+
+        emitted = cj_emit_c_expression(process, cj_find_ast_tree_node_children(node, "right")->node, &right)
+            && cj_emit_c_binary_operation(process, node, left_start, right_start, left, right, type);
+    }
+
+    cj_insert_c_prefixes(process, prefixes_length, prefixes_position);
+    cj_pop_ast_spine(&process->spine, spine_length);
+    return emitted;
+}
+
+static bool cj_emit_c_unary_expression(struct cj_emission_process* process, const struct cj_ast_tree_node* unary_expression, struct cj_static_type* type) {
+    const char* symbol = cj_find_ast_tree_node_children(unary_expression, "operator")->string;
+    enum cj_operator operator = cj_find_unary_operator(symbol, strlen(symbol));
+    struct cj_static_type argument;
+
+    size_t start = process->code_length;
+    if (!cj_emit_c_expression(process, cj_find_ast_tree_node_children(unary_expression, "argument")->node, &argument)) {
+        return false;
+    }
+
+    switch (operator) {
+        case NEGATE_OPERATOR:
+            cj_wrap_c_code(process, start, process->code_length, "(-", ")");
+            break;
+
+        case BITWISE_NOT_OPERATOR:
+            cj_wrap_c_code(process, start, process->code_length, "((double) ~cj_to_int32(", "))");
+            break;
+
+        default:
+            cj_wrap_c_code(process, start, process->code_length, "(!", ")");
+            break;
+    }
+
+    type->value_type = operator == LOGICAL_NOT_OPERATOR ? BOOLEAN_VALUE : NUMBER_VALUE;
+    type->optional = false;
+    return true;
+}
+
+static bool cj_emit_c_expression(struct cj_emission_process* process, const struct cj_ast_tree_node* expression, struct cj_static_type* type) {
+    if (strcmp(expression->type, "Literal") == 0) {
+        return cj_emit_c_literal(process, expression, type);
+    } else if (strcmp(expression->type, "Identifier") == 0) {
+        const char* name = cj_get_identifier_name(expression);
+        const struct cj_binding* binding = cj_find_binding(&process->bindings, name);
+
+        if (binding == NULL) {
+            cj_report_diagnostic(&process->diagnostics, expression->start, "`%s` is not declared", name);
+            return false;
+        } else if (binding->type != VARIABLE_BINDING) {
+            cj_report_diagnostic(&process->diagnostics, expression->start, "`%s` can only be called", name);
+            return false;
+        }
+
+        cj_append_c_code(process, "local_%zu", binding->index);
+        *type = process->variables[binding->index];
+        return true;
+    } else if (strcmp(expression->type, "CallExpression") == 0) {
+        return cj_emit_c_call_expression(process, expression, type);
+    } else if (strcmp(expression->type, "BinaryExpression") == 0) {
+        return cj_emit_c_binary_expression(process, expression, type);
+    } else if (strcmp(expression->type, "UnaryExpression") == 0) {
+        return cj_emit_c_unary_expression(process, expression, type);
+    }
+
+    cj_report_diagnostic(&process->diagnostics, expression->start, "unsupported expression");
+    return false;
+}
+
+static void cj_emit_c_variable_declaration(struct cj_emission_process* process, const struct cj_ast_tree_node* variable_declaration);
+
+static void cj_emit_c_standard_import_declaration(struct cj_emission_process* process, const struct cj_ast_tree_node* import_declaration, const struct cj_standard_module* module) {
+    for (size_t i = 0; i < import_declaration->childrens_length; i++) {
+        if (strcmp(import_declaration->childrens[i]->name, "specifier") != 0) {
+            continue;
+        }
+
+        const struct cj_ast_tree_node* specifier = import_declaration->childrens[i]->node;
+        const char* name = cj_get_identifier_name(specifier);
+        const struct cj_standard_export* export = cj_find_standard_export(module, name);
+
+        if (export == NULL) {
+            cj_report_diagnostic(&process->diagnostics, specifier->start, "module \"%s\" has no export `%s`", module->name, name);
+        } else if (cj_find_binding(&process->bindings, name) != NULL) {
+            cj_report_diagnostic(&process->diagnostics, specifier->start, "`%s` is already declared", name);
+        } else {
+            cj_emit_c_variable_declaration(process, export->declaration);
+        }
+    }
+}
+
+static void cj_emit_c_import_declaration(struct cj_emission_process* process, const struct cj_ast_tree_node* import_declaration) {
+    const struct cj_ast_tree_node* source = cj_find_ast_tree_node_children(import_declaration, "source")->node;
+    const char* module_name = cj_find_ast_tree_node_children(source, "value")->string;
+    const struct cj_native_module* module = cj_find_native_module(module_name);
+    const struct cj_standard_module* standard_module = module == NULL ? cj_find_standard_module(module_name) : NULL;
+
+    if (standard_module != NULL) {
+        cj_emit_c_standard_import_declaration(process, import_declaration, standard_module);
+        return;
+    } else if (module == NULL) {
+        cj_report_diagnostic(&process->diagnostics, source->start, "module \"%s\" not found", module_name);
+        return;
+    }
+
+    for (size_t i = 0; i < import_declaration->childrens_length; i++) {
+        if (strcmp(import_declaration->childrens[i]->name, "specifier") != 0) {
+            continue;
+        }
+
+        const struct cj_ast_tree_node* specifier = import_declaration->childrens[i]->node;
+        const char* name = cj_get_identifier_name(specifier);
+        const struct cj_native_export* export = cj_find_native_export(module, name);
+
+        if (export == NULL) {
+            cj_report_diagnostic(&process->diagnostics, specifier->start, "module \"%s\" has no export `%s`", module_name, name);
+            continue;
+        } else if (!cj_grow_c_table(process, (void**) &process->natives, &process->natives_capacity, process->natives_length, sizeof(struct cj_emitted_native), 8)
+                || !cj_bind_emitted_name(process, specifier, NATIVE_BINDING, name, process->natives_length)) {
+            continue;
+        }
+
+        process->natives[process->natives_length].module = module;
+        process->natives[process->natives_length].export = export;
+        process->natives_length++;
+    }
+}
+
+static bool cj_read_static_type(struct cj_emission_process* process, const struct cj_ast_tree_node* variable_declaration, struct cj_static_type* type) {
+    const struct cj_ast_tree_node* type_identifier = cj_find_ast_tree_node_children(variable_declaration, "type")->node;
+    const char* name = cj_get_identifier_name(type_identifier);
+
+    for (enum cj_value_type value_type = BOOLEAN_VALUE; value_type <= STRING_VALUE; value_type++) {
+        if (strcmp(name, type_names[value_type]) == 0) {
+            type->value_type = value_type;
+            type->optional = cj_find_ast_tree_node_children(variable_declaration, "optional")->boolean;
+            return true;
+        }
+    }
+
+    cj_report_diagnostic(&process->diagnostics, type_identifier->start, "unknown type `%s`", name);
+    return false;
+}
+
+static void cj_emit_c_variable_declaration(struct cj_emission_process* process, const struct cj_ast_tree_node* variable_declaration) {
+    const struct cj_ast_tree_node* id = cj_find_ast_tree_node_children(variable_declaration, "id")->node;
+    const struct cj_ast_tree_node* init = cj_find_ast_tree_node_children(variable_declaration, "init")->node;
+    struct cj_static_type type;
+    struct cj_static_type init_type;
+
+    if (!cj_read_static_type(process, variable_declaration, &type)) {
+        return;
+    }
+
+    size_t statement_start = process->code_length;
+    size_t variable = process->variables_length;
+    char c_type[32];
+
+    cj_append_c_code(process, "    %s local_%zu = ", cj_format_c_type(type, c_type), variable);
+
+    size_t init_start = process->code_length;
+    if (!cj_emit_c_expression(process, init, &init_type)) {
+        process->code_length = statement_start;
+    } else if (cj_convert_c_code(process, init_start, process->code_length, init_type, type) == 0) {
+        char type_name[16];
+        char init_type_name[16];
+        cj_report_diagnostic(&process->diagnostics, init->start, "`%s` can not be initialized with `%s`", cj_format_static_type(type, type_name), cj_format_static_type(init_type, init_type_name));
+        process->code_length = statement_start;
+    } else {
+        cj_append_c_code(process, ";\n");
+    }
+
+    if (cj_grow_c_table(process, (void**) &process->variables, &process->variables_capacity, process->variables_length, sizeof(struct cj_static_type), 64)
+            && cj_bind_emitted_name(process, id, VARIABLE_BINDING, cj_get_identifier_name(id), variable)) {
+        process->variables[process->variables_length++] = type;
+    }
+}
+
+static void cj_emit_c_expression_statement(struct cj_emission_process* process, const struct cj_ast_tree_node* expression_statement) {
+    const struct cj_ast_tree_node* expression = cj_find_ast_tree_node_children(expression_statement, "expression")->node;
+    struct cj_static_type type;
+
+    size_t statement_start = process->code_length;
+    cj_append_c_code(process, "    (void) ");
+
+    if (cj_emit_c_expression(process, expression, &type)) {
+        cj_append_c_code(process, ";\n");
+    } else {
+        process->code_length = statement_start;
+    }
+}
+
+void cj_init_emission_process(struct cj_emission_process* process, struct cj_allocator* allocator) {
+    process->allocator = allocator;
+    cj_init_diagnostic_list(&process->diagnostics, allocator);
+    cj_init_binding_table(&process->bindings, allocator);
+    cj_init_ast_spine(&process->spine);
+    process->variables_length = 0;
+    process->variables_capacity = 0;
+    process->variables = NULL;
+    process->natives_length = 0;
+    process->natives_capacity = 0;
+    process->natives = NULL;
+    process->code_length = 0;
+    process->code_capacity = 0;
+    process->code = NULL;
+    process->prefixes_position = SIZE_MAX;
+    process->prefixes_length = 0;
+    process->prefixes_capacity = 0;
+    process->prefixes = NULL;
+    process->out_of_memory = false;
+}
+
+void cj_release_emission_process(struct cj_emission_process* process) {
+    cj_release_diagnostic_list(&process->diagnostics);
+    cj_release_binding_table(&process->bindings);
+    cj_release_ast_spine(&process->spine);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->variables, sizeof(struct cj_static_type) * process->variables_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->natives, sizeof(struct cj_emitted_native) * process->natives_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->code, process->code_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->prefixes, process->prefixes_capacity);
+    process->variables = NULL;
+    process->variables_capacity = 0;
+    process->natives = NULL;
+    process->natives_capacity = 0;
+    process->code = NULL;
+    process->code_capacity = 0;
+    process->prefixes = NULL;
+    process->prefixes_capacity = 0;
+}
+
+bool cj_emit_c(struct cj_emission_process* process, const struct cj_ast_tree_node* root, FILE* stream) {
+    cj_clear_diagnostic_list(&process->diagnostics);
+    cj_clear_binding_table(&process->bindings);
+    process->variables_length = 0;
+    process->natives_length = 0;
+    process->code_length = 0;
+    process->out_of_memory = false;
+
+    for (size_t i = 0; i < root->childrens_length && !process->out_of_memory; i++) {
+        const struct cj_ast_tree_node* element = root->childrens[i]->node;
+
+        if (strcmp(element->type, "ImportDeclaration") == 0) {
+            cj_emit_c_import_declaration(process, element);
+        } else if (strcmp(element->type, "VariableDeclaration") == 0) {
+            cj_emit_c_variable_declaration(process, element);
+        } else if (strcmp(element->type, "ExpressionStatement") == 0) {
+            cj_emit_c_expression_statement(process, element);
+        }
+    }
+
+    if (process->out_of_memory) {
+        cj_report_diagnostic(&process->diagnostics, root->start, "out of memory");
+    }
+    if (process->diagnostics.length > 0 || process->diagnostics.dropped > 0) {
+        return false;
+    }
+
+    fputs(c_prelude, stream);
+    fputs("\nint main(void) {\n", stream);
+    if (process->code_length > 0) {
+        fwrite(process->code, 1, process->code_length, stream);
+    }
+    fputs("    return 0;\n}\n", stream);
+    return true;
+}
@@ -0,0 +1,90 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_C_EMITTER_H_
+#define CONJOINT_SRC_C_EMITTER_H_
+
+#include "ast.h"
+#include "binding_table.h"
+#include "diagnostic.h"
+#include "native_module.h"
+#include "value.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Type of an expression known at compile time. Optional types also admit
+ * null. */
+struct cj_static_type {
+    enum cj_value_type value_type;
+    bool optional;
+};
+
+struct cj_emitted_native {
+    const struct cj_native_module* module;
+    const struct cj_native_export* export;
+};
+
+/* Translates a Program tree into a self-contained C translation unit where
+ * every variable is a typed local of `main`. Unlike the bytecode compiler it
+ * has to know the type of every expression, so operations the VM would only
+ * reject at run time are reported as errors. */
+struct cj_emission_process {
+    struct cj_allocator* allocator;
+    struct cj_diagnostic_list diagnostics;
+    struct cj_binding_table bindings;
+    struct cj_ast_spine spine;
+
+    size_t variables_length;
+    size_t variables_capacity;
+    struct cj_static_type* variables;
+
+    size_t natives_length;
+    size_t natives_capacity;
+    struct cj_emitted_native* natives;
+
+    size_t code_length;
+    size_t code_capacity;
+    char* code;
+
+    /* Code inserted at `prefixes_position`, the start of the chain being
+     * emitted, is kept here reversed until the chain is complete. */
+    size_t prefixes_position;
+    size_t prefixes_length;
+    size_t prefixes_capacity;
+    char* prefixes;
+
+    /* Set when the code or the tables could not grow. What did not fit is
+     * dropped and the program is not written. */
+    bool out_of_memory;
+};
+
+void cj_init_emission_process(struct cj_emission_process* process, struct cj_allocator* allocator);
+
+void cj_release_emission_process(struct cj_emission_process* process);
+
+/* Writes the program to `stream` only if it has no errors and fits in
+ * memory; otherwise returns false and fills the diagnostics. Operand types are not checked here, the
+ * program is expected to have passed cj_check_types. */
+bool cj_emit_c(struct cj_emission_process* process, const struct cj_ast_tree_node* root, FILE* stream);
+
+#endif /* CONJOINT_SRC_C_EMITTER_H_ */
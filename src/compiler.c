@@ -0,0 +1,411 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "compiler.h"
+#include "native_module.h"
+#include "operator.h"
+#include "standard_module.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+static size_t cj_allocate_registers(struct cj_compilation_process* process, const struct cj_ast_tree_node* node, size_t count) {
+    size_t first = process->registers_top;
+
+    if (first + count > CJ_MAXIMUM_OPERAND) {
+        cj_report_diagnostic(&process->diagnostics, node->start, "too many registers");
+        return 0;
+    }
+
+    process->registers_top += count;
+    if (process->registers_top > process->program->registers_length) {
+        process->program->registers_length = process->registers_top;
+    }
+    return first;
+}
+
+static void cj_emit_instruction(struct cj_compilation_process* process, enum cj_opcode opcode, size_t destination) {
+    cj_emit_bytecode(process->program, cj_encode_instruction(opcode, destination));
+}
+
+static void cj_emit_operand(struct cj_compilation_process* process, size_t operand) {
+    cj_emit_bytecode(process->program, (uint32_t) operand);
+}
+
+static const char* cj_get_identifier_name(const struct cj_ast_tree_node* identifier) {
+    return cj_find_ast_tree_node_children(identifier, "value")->string;
+}
+
+static void cj_bind_compiled_name(struct cj_compilation_process* process, const struct cj_ast_tree_node* node, enum cj_binding_type type, const char* name, size_t index) {
+    enum cj_binding_status status = cj_add_binding(&process->bindings, type, name, index);
+
+    if (status == BINDING_ALREADY_BOUND) {
+        cj_report_diagnostic(&process->diagnostics, node->start, "`%s` is already declared", name);
+    } else if (status == BINDING_OUT_OF_MEMORY) {
+        process->out_of_memory = true;
+    }
+}
+
+static struct cj_value cj_compile_literal_value(struct cj_compilation_process* process, const struct cj_ast_tree_node* literal) {
+    const struct cj_ast_tree_node_children* value = cj_find_ast_tree_node_children(literal, "value");
+    struct cj_value result;
+
+    switch (value->type) {
+        case STRING_TYPE: {
+            size_t length = strlen(value->string);
+            struct cj_string* string = cj_arena_allocate(&process->program->arena, sizeof(struct cj_string));
+            char* data = cj_arena_allocate(&process->program->arena, length + 1);
+            if (string == NULL || data == NULL) {
+                cj_report_diagnostic(&process->diagnostics, literal->start, "out of memory");
+                result.type = NULL_VALUE;
+                break;
+            }
+            memcpy(data, value->string, length + 1);
+            string->length = length;
+            string->data = data;
+            result.type = STRING_VALUE;
+            result.string = string;
+            break;
+        }
+
+        case NUMBER_TYPE:
+            result.type = NUMBER_VALUE;
+            result.number = (double) value->number;
+            break;
+
+        case CHARACTER_TYPE:
+            result.type = CHARACTER_VALUE;
+            result.character = value->character;
+            break;
+
+        case BOOLEAN_TYPE:
+            result.type = BOOLEAN_VALUE;
+            result.boolean = value->boolean;
+            break;
+
+        default:
+            result.type = NULL_VALUE;
+            break;
+    }
+
+    return result;
+}
+
+static void cj_compile_expression(struct cj_compilation_process* process, const struct cj_ast_tree_node* expression, size_t destination);
+
+static void cj_compile_call_expression(struct cj_compilation_process* process, const struct cj_ast_tree_node* call_expression, size_t destination) {
+    const struct cj_ast_tree_node* callee = cj_find_ast_tree_node_children(call_expression, "callee")->node;
+    const struct cj_binding* binding = NULL;
+
+    if (strcmp(callee->type, "Identifier") == 0) {
+        binding = cj_find_binding(&process->bindings, cj_get_identifier_name(callee));
+
+        if (binding == NULL) {
+            cj_report_diagnostic(&process->diagnostics, callee->start, "`%s` is not declared", cj_get_identifier_name(callee));
+            return;
+        }
+    }
+
+    if (binding == NULL || binding->type != NATIVE_BINDING) {
+        cj_report_diagnostic(&process->diagnostics, callee->start, "expression is not callable");
+        return;
+    }
+
+    const struct cj_native_export* native = process->program->natives[binding->index];
+    size_t arguments_length = 0;
+
+    for (size_t i = 0; i < call_expression->childrens_length; i++) {
+        if (strcmp(call_expression->childrens[i]->name, "argument") == 0) {
+            arguments_length++;
+        }
+    }
+
+    if (arguments_length != native->arity) {
+        cj_report_diagnostic(&process->diagnostics, call_expression->start, "`%s` expects %zu arguments, %zu given", native->name, native->arity, arguments_length);
+        return;
+    }
+
+    size_t registers_top = process->registers_top;
+    size_t first_argument = cj_allocate_registers(process, call_expression, arguments_length);
+
+    for (size_t i = 0, j = 0; i < call_expression->childrens_length; i++) {
+        if (strcmp(call_expression->childrens[i]->name, "argument") == 0) {
+            cj_compile_expression(process, call_expression->childrens[i]->node, first_argument + j++);
+        }
+    }
+
+    cj_emit_instruction(process, OP_CALL_NATIVE, destination);
+    cj_emit_operand(process, binding->index);
+    cj_emit_operand(process, first_argument);
+    cj_emit_operand(process, arguments_length);
+
+    process->registers_top = registers_top;
+}
+
+static const enum cj_opcode operator_opcodes[] = {
+    [BITWISE_OR_OPERATOR] = OP_BITWISE_OR,
+    [BITWISE_XOR_OPERATOR] = OP_BITWISE_XOR,
+    [BITWISE_AND_OPERATOR] = OP_BITWISE_AND,
+    [EQUAL_OPERATOR] = OP_EQUAL,
+    [NOT_EQUAL_OPERATOR] = OP_NOT_EQUAL,
+    [LESS_OPERATOR] = OP_LESS,
+    [GREATER_OPERATOR] = OP_GREATER,
+    [LEFT_SHIFT_OPERATOR] = OP_LEFT_SHIFT,
+    [RIGHT_SHIFT_OPERATOR] = OP_RIGHT_SHIFT,
+    [UNSIGNED_RIGHT_SHIFT_OPERATOR] = OP_UNSIGNED_RIGHT_SHIFT,
+    [ADD_OPERATOR] = OP_ADD,
+    [SUBTRACT_OPERATOR] = OP_SUBTRACT,
+    [MULTIPLY_OPERATOR] = OP_MULTIPLY,
+    [DIVIDE_OPERATOR] = OP_DIVIDE,
+    [REMAINDER_OPERATOR] = OP_REMAINDER,
+    [NEGATE_OPERATOR] = OP_NEGATE,
+    [BITWISE_NOT_OPERATOR] = OP_BITWISE_NOT,
+    [LOGICAL_NOT_OPERATOR] = OP_NOT
+};
+
+/* Variables are used in place, anything else goes through a temporary
+ * register that the caller releases. */
+static size_t cj_compile_operand(struct cj_compilation_process* process, const struct cj_ast_tree_node* expression) {
+    if (strcmp(expression->type, "Identifier") == 0) {
+        const struct cj_binding* binding = cj_find_binding(&process->bindings, cj_get_identifier_name(expression));
+        if (binding != NULL && binding->type == VARIABLE_BINDING) {
+            return binding->index;
+        }
+    }
+
+    size_t operand = cj_allocate_registers(process, expression, 1);
+    cj_compile_expression(process, expression, operand);
+    return operand;
+}
+
+/* A chain is compiled from its innermost expression out, each result going
+ * to `destination` to be the left operand of the next one. The operands of
+ * `&&` and `||` are Boolean by `cj_check_types`, so the jumps need no check
+ * of the right one. */
+static void cj_compile_binary_expression(struct cj_compilation_process* process, const struct cj_ast_tree_node* binary_expression, size_t destination) {
+    size_t spine_length = cj_push_ast_spine(&process->spine, binary_expression);
+    size_t registers_top = process->registers_top;
+    const struct cj_ast_tree_node* innermost = process->spine.nodes[process->spine.length - 1];
+    const char* symbol = cj_find_ast_tree_node_children(innermost, "operator")->string;
+    enum cj_operator operator = cj_find_binary_operator(symbol, strlen(symbol));
+    size_t left = destination;
+
+    if (operator == LOGICAL_AND_OPERATOR || operator == LOGICAL_OR_OPERATOR) {
+        cj_compile_expression(process, cj_find_ast_tree_node_children(innermost, "left")->node, destination);
+    } else {
+        left = cj_compile_operand(process, cj_find_ast_tree_node_children(innermost, "left")->node);
+    }
+
+    for (size_t i = process->spine.length; i-- > spine_length;) {
+        const struct cj_ast_tree_node* node = process->spine.nodes[i];
+        const struct cj_ast_tree_node* right = cj_find_ast_tree_node_children(node, "right")->node;
+        symbol = cj_find_ast_tree_node_children(node, "operator")->string;
+        operator = cj_find_binary_operator(symbol, strlen(symbol));
+
+        if (operator == LOGICAL_AND_OPERATOR || operator == LOGICAL_OR_OPERATOR) {
+            if (left != destination) {
+                cj_emit_instruction(process, OP_MOVE, destination);
+                cj_emit_operand(process, left);
+            }
+
+            cj_emit_instruction(process, operator == LOGICAL_AND_OPERATOR ? OP_JUMP_IF_FALSE : OP_JUMP_IF_TRUE, destination);
+            size_t target = cj_emit_bytecode(process->program, 0);
+
+            cj_compile_expression(process, right, destination);
+
+            if (!process->program->out_of_memory) {
+                process->program->code[target] = (uint32_t) process->program->code_length;
+            }
+        } else {
+            size_t right_operand = cj_compile_operand(process, right);
+
+            cj_emit_instruction(process, operator_opcodes[operator], destination);
+            cj_emit_operand(process, left);
+            cj_emit_operand(process, right_operand);
+        }
+
+        left = destination;
+        process->registers_top = registers_top;
+    }
+
+    cj_pop_ast_spine(&process->spine, spine_length);
+}
+
+static void cj_compile_unary_expression(struct cj_compilation_process* process, const struct cj_ast_tree_node* unary_expression, size_t destination) {
+    const char* symbol = cj_find_ast_tree_node_children(unary_expression, "operator")->string;
+    enum cj_operator operator = cj_find_unary_operator(symbol, strlen(symbol));
+
+    size_t registers_top = process->registers_top;
+    size_t argument = cj_compile_operand(process, cj_find_ast_tree_node_children(unary_expression, "argument")->node);
+
+    cj_emit_instruction(process, operator_opcodes[operator], destination);
+    cj_emit_operand(process, argument);
+
+    process->registers_top = registers_top;
+}
+
+static void cj_compile_expression(struct cj_compilation_process* process, const struct cj_ast_tree_node* expression, size_t destination) {
+    if (strcmp(expression->type, "Literal") == 0) {
+        size_t constant = cj_add_bytecode_constant(process->program, cj_compile_literal_value(process, expression));
+        cj_emit_instruction(process, OP_LOAD_CONSTANT, destination);
+        cj_emit_operand(process, constant);
+    } else if (strcmp(expression->type, "Identifier") == 0) {
+        const char* name = cj_get_identifier_name(expression);
+        const struct cj_binding* binding = cj_find_binding(&process->bindings, name);
+
+        if (binding == NULL) {
+            cj_report_diagnostic(&process->diagnostics, expression->start, "`%s` is not declared", name);
+        } else if (binding->type != VARIABLE_BINDING) {
+            cj_report_diagnostic(&process->diagnostics, expression->start, "`%s` can only be called", name);
+        } else if (binding->index != destination) {
+            cj_emit_instruction(process, OP_MOVE, destination);
+            cj_emit_operand(process, binding->index);
+        }
+    } else if (strcmp(expression->type, "CallExpression") == 0) {
+        cj_compile_call_expression(process, expression, destination);
+    } else if (strcmp(expression->type, "BinaryExpression") == 0) {
+        cj_compile_binary_expression(process, expression, destination);
+    } else if (strcmp(expression->type, "UnaryExpression") == 0) {
+        cj_compile_unary_expression(process, expression, destination);
+    } else {
+        cj_report_diagnostic(&process->diagnostics, expression->start, "unsupported expression");
+    }
+}
+
+static void cj_compile_variable_declaration(struct cj_compilation_process* process, const struct cj_ast_tree_node* variable_declaration);
+
+/* Standard modules only export declarations initialized with a literal, so
+ * an import loads the values into variables of the program. */
+static void cj_compile_standard_import_declaration(struct cj_compilation_process* process, const struct cj_ast_tree_node* import_declaration, const struct cj_standard_module* module) {
+    for (size_t i = 0; i < import_declaration->childrens_length; i++) {
+        if (strcmp(import_declaration->childrens[i]->name, "specifier") != 0) {
+            continue;
+        }
+
+        const struct cj_ast_tree_node* specifier = import_declaration->childrens[i]->node;
+        const char* name = cj_get_identifier_name(specifier);
+        const struct cj_standard_export* export = cj_find_standard_export(module, name);
+
+        if (export == NULL) {
+            cj_report_diagnostic(&process->diagnostics, specifier->start, "module \"%s\" has no export `%s`", module->name, name);
+        } else if (cj_find_binding(&process->bindings, name) != NULL) {
+            cj_report_diagnostic(&process->diagnostics, specifier->start, "`%s` is already declared", name);
+        } else {
+            cj_compile_variable_declaration(process, export->declaration);
+        }
+    }
+}
+
+static void cj_compile_import_declaration(struct cj_compilation_process* process, const struct cj_ast_tree_node* import_declaration) {
+    const struct cj_ast_tree_node* source = cj_find_ast_tree_node_children(import_declaration, "source")->node;
+    const char* module_name = cj_find_ast_tree_node_children(source, "value")->string;
+    const struct cj_native_module* module = cj_find_native_module(module_name);
+    const struct cj_standard_module* standard_module = module == NULL ? cj_find_standard_module(module_name) : NULL;
+
+    if (standard_module != NULL) {
+        cj_compile_standard_import_declaration(process, import_declaration, standard_module);
+        return;
+    } else if (module == NULL) {
+        cj_report_diagnostic(&process->diagnostics, source->start, "module \"%s\" not found", module_name);
+        return;
+    }
+
+    for (size_t i = 0; i < import_declaration->childrens_length; i++) {
+        if (strcmp(import_declaration->childrens[i]->name, "specifier") != 0) {
+            continue;
+        }
+
+        const struct cj_ast_tree_node* specifier = import_declaration->childrens[i]->node;
+        const char* name = cj_get_identifier_name(specifier);
+        const struct cj_native_export* native = cj_find_native_export(module, name);
+
+        if (native == NULL) {
+            cj_report_diagnostic(&process->diagnostics, specifier->start, "module \"%s\" has no export `%s`", module_name, name);
+        } else {
+            cj_bind_compiled_name(process, specifier, NATIVE_BINDING, name, cj_add_bytecode_native(process->program, native));
+        }
+    }
+}
+
+static void cj_compile_variable_declaration(struct cj_compilation_process* process, const struct cj_ast_tree_node* variable_declaration) {
+    const struct cj_ast_tree_node* id = cj_find_ast_tree_node_children(variable_declaration, "id")->node;
+    const struct cj_ast_tree_node* init = cj_find_ast_tree_node_children(variable_declaration, "init")->node;
+
+    size_t variable = cj_allocate_registers(process, variable_declaration, 1);
+    cj_compile_expression(process, init, variable);
+
+    cj_bind_compiled_name(process, id, VARIABLE_BINDING, cj_get_identifier_name(id), variable);
+}
+
+static void cj_compile_expression_statement(struct cj_compilation_process* process, const struct cj_ast_tree_node* expression_statement) {
+    const struct cj_ast_tree_node* expression = cj_find_ast_tree_node_children(expression_statement, "expression")->node;
+
+    size_t registers_top = process->registers_top;
+    size_t result = cj_allocate_registers(process, expression_statement, 1);
+    cj_compile_expression(process, expression, result);
+    process->registers_top = registers_top;
+}
+
+void cj_init_compilation_process(struct cj_compilation_process* process, struct cj_allocator* allocator) {
+    process->program = NULL;
+    cj_init_diagnostic_list(&process->diagnostics, allocator);
+    cj_init_binding_table(&process->bindings, allocator);
+    cj_init_ast_spine(&process->spine);
+    process->registers_top = 0;
+    process->out_of_memory = false;
+}
+
+void cj_release_compilation_process(struct cj_compilation_process* process) {
+    cj_release_diagnostic_list(&process->diagnostics);
+    cj_release_binding_table(&process->bindings);
+    cj_release_ast_spine(&process->spine);
+    process->program = NULL;
+}
+
+bool cj_compile(struct cj_compilation_process* process, const struct cj_ast_tree_node* root, struct cj_bytecode_program* program) {
+    process->program = program;
+    cj_reset_bytecode_program(program);
+    cj_clear_diagnostic_list(&process->diagnostics);
+
+    cj_clear_binding_table(&process->bindings);
+    process->registers_top = 0;
+    process->out_of_memory = false;
+
+    for (size_t i = 0; i < root->childrens_length && !process->out_of_memory && !program->out_of_memory; i++) {
+        const struct cj_ast_tree_node* element = root->childrens[i]->node;
+
+        if (strcmp(element->type, "ImportDeclaration") == 0) {
+            cj_compile_import_declaration(process, element);
+        } else if (strcmp(element->type, "VariableDeclaration") == 0) {
+            cj_compile_variable_declaration(process, element);
+        } else if (strcmp(element->type, "ExpressionStatement") == 0) {
+            cj_compile_expression_statement(process, element);
+        }
+    }
+
+    cj_emit_instruction(process, OP_HALT, 0);
+
+    if (process->out_of_memory || program->out_of_memory) {
+        cj_report_diagnostic(&process->diagnostics, root->start, "out of memory");
+    }
+    return process->diagnostics.length == 0 && process->diagnostics.dropped == 0;
+}
@@ -0,0 +1,58 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_COMPILER_H_
+#define CONJOINT_SRC_COMPILER_H_
+
+#include "ast.h"
+#include "binding_table.h"
+#include "bytecode.h"
+#include "diagnostic.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Lowers a Program tree into register bytecode. Like the parsing process it
+ * can be reused for many programs. */
+struct cj_compilation_process {
+    struct cj_bytecode_program* program;
+    struct cj_diagnostic_list diagnostics;
+
+    struct cj_binding_table bindings;
+    struct cj_ast_spine spine;
+
+    size_t registers_top;
+
+    /* Set when a name could not be bound. Like a program out of memory, it
+     * stops the compilation with a single diagnostic. */
+    bool out_of_memory;
+};
+
+void cj_init_compilation_process(struct cj_compilation_process* process, struct cj_allocator* allocator);
+
+void cj_release_compilation_process(struct cj_compilation_process* process);
+
+/* Returns false and fills the diagnostics if the program can not be
+ * compiled. Declared and operand types are not checked here, the program is
+ * expected to have passed cj_check_types. */
+bool cj_compile(struct cj_compilation_process* process, const struct cj_ast_tree_node* root, struct cj_bytecode_program* program);
+
+#endif /* CONJOINT_SRC_COMPILER_H_ */
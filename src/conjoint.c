@@ -19,27 +19,273 @@
  * THE SOFTWARE.
  */
 
+#include "allocator.h"
 #include "source_file.h"
+#include "type_checker.h"
 #include "parser.h"
+#include "profiler.h"
+#include "prune.h"
+#include "c_emitter.h"
+#include "compiler.h"
+#include "fold.h"
+#include "name_index.h"
+#include "native_module.h"
+#include "standard_module.h"
+#include "vm.h"
+#include "watch.h"
 
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CJ_PROFILE_REPORT_LENGTH 10
+
+/* Appends the index of the parsed file to the one stored at `path`, which
+ * is created if missing or not an index. Reading it back lets the new
+ * segment replace the file's earlier ones, so usually nothing stored is
+ * rewritten. Once the appended segments are as long as the ones written
+ * with the index, it is read back and written again, which drops the
+ * superseded segments and keeps the file within twice its live length. */
+static bool cj_update_name_index_file(const char* path, const struct cj_name_index* name_index, struct cj_allocator* allocator) {
+    uint64_t written_length, appended_length;
+    FILE* stream = fopen(path, "r+b");
+    bool stored = stream != NULL && cj_read_name_index_header(stream, &written_length, &appended_length);
+
+    struct cj_name_index stored_index;
+    cj_init_name_index(&stored_index, allocator);
+    const struct cj_name_index* written_index = stored ? NULL : name_index;
+
+    /* An index that can not be read back is appended to as before. */
+    if (stored && appended_length >= written_length) {
+        rewind(stream);
+        if (cj_read_name_index(&stored_index, stream) && cj_merge_name_index(&stored_index, name_index)) {
+            written_index = &stored_index;
+        }
+    }
+
+    bool updated;
+    if (written_index != NULL) {
+        if (stream != NULL) {
+            fclose(stream);
+        }
+        stream = fopen(path, "wb");
+        updated = stream != NULL && cj_write_name_index(written_index, stream);
+    } else {
+        updated = cj_append_name_index(name_index, stream);
+    }
+
+    if (stream != NULL && fclose(stream) != 0) {
+        updated = false;
+    }
+    cj_release_name_index(&stored_index);
+    return updated;
+}
+
+static bool cj_resolve_import(const char* module_name, const char* name, const struct cj_ast_tree_node** declaration) {
+    const struct cj_native_module* module = cj_find_native_module(module_name);
+    if (module != NULL) {
+        *declaration = NULL;
+        return cj_find_native_export(module, name) != NULL;
+    }
+
+    const struct cj_standard_module* standard_module = cj_find_standard_module(module_name);
+    const struct cj_standard_export* export = standard_module != NULL ? cj_find_standard_export(standard_module, name) : NULL;
+    *declaration = export != NULL ? export->declaration : NULL;
+    return export != NULL;
+}
 
 int main(int argc, char* argv[]) {
-	if (argc < 2) {
-		printf("Usage: %s SOURCE_FILE\n", argv[0]);
+	bool print_bytecode = false;
+	bool emit_c = false;
+	bool watch = false;
+	bool print_memory_usage = false;
+	bool print_pruning_statistics = false;
+	char* path = NULL;
+	char* profile_path = NULL;
+	char* index_path = NULL;
+
+	struct cj_allocator allocator;
+	cj_init_allocator(&allocator);
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--print-bytecode") == 0) {
+			print_bytecode = true;
+		} else if (strcmp(argv[i], "--emit-c") == 0) {
+			emit_c = true;
+		} else if (strcmp(argv[i], "--watch") == 0) {
+			watch = true;
+		} else if (strcmp(argv[i], "--memory-limit") == 0 && i + 1 < argc) {
+			allocator.limit = (size_t) strtoull(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--memory-usage") == 0) {
+			print_memory_usage = true;
+		} else if (strcmp(argv[i], "--pruning-statistics") == 0) {
+			print_pruning_statistics = true;
+		} else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+			profile_path = argv[++i];
+		} else if (strcmp(argv[i], "--index") == 0 && i + 1 < argc) {
+			index_path = argv[++i];
+		} else {
+			path = argv[i];
+		}
+	}
+
+	if (path == NULL) {
+		printf("Usage: %s [--print-bytecode | --emit-c] [--memory-limit BYTES] [--memory-usage] [--pruning-statistics] [--profile FILE] [--index FILE] SOURCE_FILE\n", argv[0]);
+		printf("       %s --watch DIRECTORY\n", argv[0]);
 		return 1;
 	}
 
+	if (watch) {
+#ifdef __linux__
+		struct cj_watching_process watching_process;
+		cj_init_watching_process(&watching_process, &allocator);
+		bool watching = cj_watch(&watching_process, path);
+		cj_release_watching_process(&watching_process);
+
+		if (watching_process.out_of_memory) {
+			printf("Out of memory while watching \"%s\"\n", path);
+		} else if (!watching) {
+			printf("Unable to watch directory \"%s\"\n", path);
+		}
+#else
+		printf("--watch is only supported on Linux\n");
+#endif
+		return 2;
+	}
+
 	struct cj_source_file source_file = {
-		.path = argv[1]
+		.path = path,
+		.allocator = &allocator
 	};
 
-	if (cj_read_source_file(&source_file) < 0) {
+	int read_status = cj_read_source_file(&source_file);
+
+	if (read_status == -2) {
+		printf("File \"%s\" is not valid UTF-8\n", source_file.path);
+		return 2;
+	} else if (read_status == -3) {
+		printf("File \"%s\" does not fit in memory\n", source_file.path);
+		return 2;
+	} else if (read_status < 0) {
 		printf("Unable to read file \"%s\"\n", source_file.path);
 		return 2;
 	}
 
-    cj_parse(&source_file);
+    int status = 0;
+
+    struct cj_parsing_process parsing_process;
+    cj_init_parsing_process(&parsing_process, &allocator);
+
+    struct cj_compilation_process compilation_process;
+    cj_init_compilation_process(&compilation_process, &allocator);
+
+    struct cj_type_checking_process type_checking_process;
+    cj_init_type_checking_process(&type_checking_process, &allocator);
+    type_checking_process.import_resolver = cj_resolve_import;
+
+    struct cj_pruning_process pruning_process;
+    cj_init_pruning_process(&pruning_process, &allocator);
+
+    struct cj_emission_process emission_process;
+    cj_init_emission_process(&emission_process, &allocator);
+
+    struct cj_bytecode_program program;
+    cj_init_bytecode_program(&program, &allocator);
+
+    struct cj_virtual_machine machine;
+    cj_init_virtual_machine(&machine, &allocator, stdout);
+
+#ifdef CJ_PROFILE
+    struct cj_profiling_process profiling_process;
+    cj_init_profiling_process(&profiling_process, CJ_PROFILE_REPORT_LENGTH);
+    if (profile_path != NULL) {
+        parsing_process.profiling_process = &profiling_process;
+    }
+#endif
+
+    struct cj_name_index name_index;
+    cj_init_name_index(&name_index, &allocator);
+    if (index_path != NULL) {
+        parsing_process.name_index = &name_index;
+    }
+
+    struct cj_ast_tree_node* root = cj_parse(&parsing_process, &source_file);
+
+    /* A failed parse would replace the sites of the file with partial ones. */
+    if (index_path != NULL && root != NULL && parsing_process.diagnostics.length == 0
+            && !cj_update_name_index_file(index_path, &name_index, &allocator)) {
+        fprintf(stderr, "Unable to update index \"%s\"\n", index_path);
+    }
+
+    if (profile_path != NULL) {
+#ifdef CJ_PROFILE
+        FILE* profile = fopen(profile_path, "w");
+        if (profile != NULL) {
+            cj_write_folded_stacks(&profiling_process, profile);
+            fclose(profile);
+        } else {
+            fprintf(stderr, "Unable to write profile \"%s\"\n", profile_path);
+        }
+        cj_print_profile_report(&profiling_process, &source_file, stderr);
+#else
+        fprintf(stderr, "--profile requires a build with CJ_PROFILE defined\n");
+#endif
+    }
+
+    bool typed = true;
+
+    if (root != NULL && parsing_process.diagnostics.length == 0) {
+        cj_fold_constants(&parsing_process.arena, root);
+        typed = cj_check_types(&type_checking_process, root);
+
+        if (typed && cj_prune_program(&pruning_process, root) && print_pruning_statistics) {
+            cj_print_pruning_statistics(&pruning_process.statistics, stderr);
+        }
+    }
+
+    if (parsing_process.out_of_memory) {
+        cj_print_diagnostic_list(&parsing_process.diagnostics, &source_file);
+        printf("Out of memory while parsing \"%s\"\n", source_file.path);
+        status = 2;
+    } else if (parsing_process.diagnostics.length > 0) {
+        cj_print_diagnostic_list(&parsing_process.diagnostics, &source_file);
+        status = 3;
+    } else if (!typed) {
+        cj_print_diagnostic_list(&type_checking_process.diagnostics, &source_file);
+        status = 3;
+    } else if (emit_c) {
+        if (!cj_emit_c(&emission_process, root, stdout)) {
+            cj_print_diagnostic_list(&emission_process.diagnostics, &source_file);
+            status = 3;
+        }
+    } else if (!cj_compile(&compilation_process, root, &program)) {
+        cj_print_diagnostic_list(&compilation_process.diagnostics, &source_file);
+        status = 3;
+    } else if (print_bytecode) {
+        cj_print_bytecode_program(&program);
+    } else if (!cj_execute(&machine, &program)) {
+        cj_flush_output(&machine);
+        fprintf(stderr, "runtime error: %s\n", machine.error);
+        status = 4;
+    }
+
+    cj_release_virtual_machine(&machine);
+    cj_release_bytecode_program(&program);
+    cj_release_emission_process(&emission_process);
+    cj_release_pruning_process(&pruning_process);
+    cj_release_type_checking_process(&type_checking_process);
+    cj_release_name_index(&name_index);
+    cj_release_compilation_process(&compilation_process);
+    cj_release_parsing_process(&parsing_process);
+#ifdef CJ_PROFILE
+    cj_release_profiling_process(&profiling_process);
+#endif
+    cj_release_source_file(&source_file);
+
+    if (print_memory_usage) {
+        cj_print_memory_usage(&allocator, stderr);
+    }
 
-	return 0;
+	return status;
 }
@@ -0,0 +1,82 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "diagnostic.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+void cj_init_diagnostic_list(struct cj_diagnostic_list* list, struct cj_allocator* allocator) {
+    list->allocator = allocator;
+    list->length = 0;
+    list->capacity = 0;
+    list->diagnostics = NULL;
+    list->dropped = 0;
+}
+
+void cj_report_diagnostic(struct cj_diagnostic_list* list, size_t position, const char* format, ...) {
+    if (list->length == list->capacity) {
+        size_t capacity = list->capacity > 0 ? list->capacity * 2 : 4;
+        struct cj_diagnostic* diagnostics = cj_reallocate(list->allocator, DIAGNOSTIC_MEMORY, list->diagnostics,
+            sizeof(struct cj_diagnostic) * list->capacity,
+            sizeof(struct cj_diagnostic) * capacity);
+
+        if (diagnostics == NULL) {
+            list->dropped++;
+            return;
+        }
+
+        list->diagnostics = diagnostics;
+        list->capacity = capacity;
+    }
+
+    struct cj_diagnostic* diagnostic = &list->diagnostics[list->length++];
+    diagnostic->position = position;
+
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(diagnostic->message, sizeof(diagnostic->message), format, arguments);
+    va_end(arguments);
+}
+
+void cj_clear_diagnostic_list(struct cj_diagnostic_list* list) {
+    list->length = 0;
+    list->dropped = 0;
+}
+
+void cj_release_diagnostic_list(struct cj_diagnostic_list* list) {
+    cj_deallocate(list->allocator, DIAGNOSTIC_MEMORY, list->diagnostics, sizeof(struct cj_diagnostic) * list->capacity);
+    cj_init_diagnostic_list(list, list->allocator);
+}
+
+void cj_print_diagnostic_list(const struct cj_diagnostic_list* list, struct cj_source_file* source_file) {
+    const char* path = source_file->path ? source_file->path : "<input>";
+
+    for (size_t i = 0; i < list->length; i++) {
+        const struct cj_diagnostic* diagnostic = &list->diagnostics[i];
+        struct cj_source_position position = cj_locate_source_position(source_file, diagnostic->position);
+        fprintf(stderr, "%s:%zu:%zu: error: %s\n", path, position.line + 1, position.column + 1, diagnostic->message);
+    }
+
+    if (list->dropped > 0) {
+        fprintf(stderr, "%s: %zu more errors could not be recorded\n", path, list->dropped);
+    }
+}
@@ -0,0 +1,56 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_DIAGNOSTIC_H_
+#define CONJOINT_SRC_DIAGNOSTIC_H_
+
+#include "allocator.h"
+#include "source_file.h"
+
+#include <stddef.h>
+
+struct cj_diagnostic {
+    char message[96];
+    size_t position;
+};
+
+struct cj_diagnostic_list {
+    struct cj_allocator* allocator;
+    size_t length;
+    size_t capacity;
+    struct cj_diagnostic* diagnostics;
+
+    /* Diagnostics that were reported while the list could not grow. */
+    size_t dropped;
+};
+
+void cj_init_diagnostic_list(struct cj_diagnostic_list* list, struct cj_allocator* allocator);
+
+/* The diagnostic is dropped, and only counted, if the list can not grow. */
+void cj_report_diagnostic(struct cj_diagnostic_list* list, size_t position, const char* format, ...);
+
+void cj_clear_diagnostic_list(struct cj_diagnostic_list* list);
+
+void cj_release_diagnostic_list(struct cj_diagnostic_list* list);
+
+void cj_print_diagnostic_list(const struct cj_diagnostic_list* list, struct cj_source_file* source_file);
+
+#endif /* CONJOINT_SRC_DIAGNOSTIC_H_ */
@@ -0,0 +1,291 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Build tool generating the cj_standard_modules table from the standard
+ * library sources. Usage: embed_standard_modules OUTPUT MODULE_FILE...
+ * The name of each module is its file name without the .cj suffix. */
+
+#include "fold.h"
+#include "parser.h"
+#include "source_file.h"
+#include "type_checker.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+struct cj_embedding_process {
+    FILE* output;
+    size_t module;
+    size_t nodes_length;
+};
+
+static void cj_write_c_string(FILE* output, const char* string) {
+    fputc('"', output);
+    for (; *string; string++) {
+        unsigned char character = *string;
+
+        if (character >= 0x20 && character < 0x7F && character != '"' && character != '\\' && character != '?') {
+            fputc(character, output);
+        } else {
+            fprintf(output, "\\%03o", character);
+        }
+    }
+    fputc('"', output);
+}
+
+static void cj_write_number(FILE* output, long double number) {
+    if (number != number) {
+        fputs("(long double) NAN", output);
+    } else if (number == 1.0L / 0.0L || number == -1.0L / 0.0L) {
+        fputs(number < 0 ? "-(long double) INFINITY" : "(long double) INFINITY", output);
+    } else {
+        fprintf(output, "%LaL", number);
+    }
+}
+
+/* Writes the node after everything it refers to, and returns its index. */
+static size_t cj_write_node(struct cj_embedding_process* process, const struct cj_ast_tree_node* node) {
+    size_t related[node->childrens_length + 1];
+
+    for (size_t i = 0; i < node->childrens_length; i++) {
+        if (node->childrens[i]->type == NODE_TYPE) {
+            related[i] = cj_write_node(process, node->childrens[i]->node);
+        }
+    }
+
+    size_t index = process->nodes_length++;
+    FILE* output = process->output;
+
+    for (size_t i = 0; i < node->childrens_length; i++) {
+        const struct cj_ast_tree_node_children* children = node->childrens[i];
+
+        fprintf(output, "static const struct cj_ast_tree_node_children module_%zu_node_%zu_children_%zu = {.name = ", process->module, index, i);
+        cj_write_c_string(output, children->name);
+
+        switch (children->type) {
+            case NODE_TYPE:
+                fprintf(output, ", .type = NODE_TYPE, .node = (struct cj_ast_tree_node*) &module_%zu_node_%zu", process->module, related[i]);
+                break;
+
+            case STRING_TYPE:
+                fputs(", .type = STRING_TYPE, .string = ", output);
+                cj_write_c_string(output, children->string);
+                break;
+
+            case NUMBER_TYPE:
+                fputs(", .type = NUMBER_TYPE, .number = ", output);
+                cj_write_number(output, children->number);
+                break;
+
+            case CHARACTER_TYPE:
+                fprintf(output, ", .type = CHARACTER_TYPE, .character = %lu", (unsigned long) children->character);
+                break;
+
+            case BOOLEAN_TYPE:
+                fprintf(output, ", .type = BOOLEAN_TYPE, .boolean = %s", children->boolean ? "true" : "false");
+                break;
+
+            case NULL_TYPE:
+                fputs(", .type = NULL_TYPE", output);
+                break;
+        }
+
+        fputs("};\n", output);
+    }
+
+    if (node->childrens_length > 0) {
+        fprintf(output, "static struct cj_ast_tree_node_children* const module_%zu_node_%zu_childrens[] = {\n", process->module, index);
+        for (size_t i = 0; i < node->childrens_length; i++) {
+            fprintf(output, "    (struct cj_ast_tree_node_children*) &module_%zu_node_%zu_children_%zu,\n", process->module, index, i);
+        }
+        fputs("};\n", output);
+    }
+
+    fprintf(output, "static const struct cj_ast_tree_node module_%zu_node_%zu = {.type = ", process->module, index);
+    cj_write_c_string(output, node->type);
+    fprintf(output, ", .start = %zu, .end = %zu, .childrens_length = %zu, .childrens_capacity = %zu, .childrens = ", node->start, node->end, node->childrens_length, node->childrens_length);
+
+    if (node->childrens_length > 0) {
+        fprintf(output, "(struct cj_ast_tree_node_children**) module_%zu_node_%zu_childrens};\n\n", process->module, index);
+    } else {
+        fputs("NULL};\n\n", output);
+    }
+
+    return index;
+}
+
+/* Only declarations folded to a literal can be embedded, so that importing
+ * them needs no code from the module. */
+static bool cj_check_module_element(const struct cj_ast_tree_node* element, struct cj_source_file* source_file) {
+    struct cj_source_position position = cj_locate_source_position(source_file, element->start);
+
+    if (strcmp(element->type, "VariableDeclaration") != 0) {
+        fprintf(stderr, "%s:%zu:%zu: error: standard modules can only contain declarations\n", source_file->path, position.line + 1, position.column + 1);
+        return false;
+    }
+
+    const struct cj_ast_tree_node* init = cj_find_ast_tree_node_children(element, "init")->node;
+    if (strcmp(init->type, "Literal") != 0) {
+        position = cj_locate_source_position(source_file, init->start);
+        fprintf(stderr, "%s:%zu:%zu: error: initializer is not constant\n", source_file->path, position.line + 1, position.column + 1);
+        return false;
+    }
+
+    return true;
+}
+
+static bool cj_embed_module(struct cj_embedding_process* process, struct cj_parsing_process* parsing_process, struct cj_type_checking_process* type_checking_process, struct cj_source_file* source_file, FILE* exports) {
+    if (cj_read_source_file(source_file) != 0) {
+        fprintf(stderr, "Unable to read file \"%s\"\n", source_file->path);
+        return false;
+    }
+
+    struct cj_ast_tree_node* root = cj_parse(parsing_process, source_file);
+
+    if (root == NULL || parsing_process->diagnostics.length > 0) {
+        cj_print_diagnostic_list(&parsing_process->diagnostics, source_file);
+        return false;
+    }
+
+    cj_fold_constants(&parsing_process->arena, root);
+
+    if (!cj_check_types(type_checking_process, root)) {
+        cj_print_diagnostic_list(&type_checking_process->diagnostics, source_file);
+        return false;
+    }
+
+    size_t exports_length = 0;
+
+    for (size_t i = 0; i < root->childrens_length; i++) {
+        const struct cj_ast_tree_node* element = root->childrens[i]->node;
+
+        if (strcmp(element->type, "Comment") == 0) {
+            continue;
+        } else if (!cj_check_module_element(element, source_file)) {
+            return false;
+        }
+
+        const struct cj_ast_tree_node* id = cj_find_ast_tree_node_children(element, "id")->node;
+        size_t declaration = cj_write_node(process, element);
+
+        fputs("    {", exports);
+        cj_write_c_string(exports, cj_find_ast_tree_node_children(id, "value")->string);
+        fprintf(exports, ", &module_%zu_node_%zu},\n", process->module, declaration);
+        exports_length++;
+    }
+
+    if (exports_length == 0) {
+        fprintf(stderr, "%s: error: module has no declarations\n", source_file->path);
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		printf("Usage: %s OUTPUT MODULE_FILE...\n", argv[0]);
+		return 1;
+	}
+
+    FILE* output = fopen(argv[1], "w");
+    if (output == NULL) {
+        printf("Unable to write file \"%s\"\n", argv[1]);
+        return 2;
+    }
+
+    /* Export tables are collected aside and written after all the nodes. */
+    FILE* exports = tmpfile();
+    if (exports == NULL) {
+        fclose(output);
+        return 2;
+    }
+
+    struct cj_allocator allocator;
+    cj_init_allocator(&allocator);
+
+    struct cj_parsing_process parsing_process;
+    cj_init_parsing_process(&parsing_process, &allocator);
+
+    struct cj_type_checking_process type_checking_process;
+    cj_init_type_checking_process(&type_checking_process, &allocator);
+
+    struct cj_embedding_process process = {
+        .output = output
+    };
+
+    int status = 0;
+
+    fputs("/* Generated by embed_standard_modules, do not edit. */\n\n", output);
+    fputs("#include \"standard_module.h\"\n\n#include <math.h>\n#include <stddef.h>\n\n", output);
+
+    for (int i = 2; i < argc && status == 0; i++) {
+        struct cj_source_file source_file = {
+            .path = argv[i],
+            .allocator = &allocator
+        };
+
+        process.module = i - 2;
+        process.nodes_length = 0;
+        fprintf(exports, "static const struct cj_standard_export module_%zu_exports[] = {\n", process.module);
+
+        if (!cj_embed_module(&process, &parsing_process, &type_checking_process, &source_file, exports)) {
+            status = 3;
+        }
+
+        fputs("};\n\n", exports);
+        cj_release_source_file(&source_file);
+    }
+
+    rewind(exports);
+    char buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), exports)) > 0) {
+        fwrite(buffer, 1, length, output);
+    }
+    fclose(exports);
+
+    fprintf(output, "const size_t cj_standard_modules_length = %d;\n\n", argc - 2);
+    fputs("const struct cj_standard_module cj_standard_modules[] = {\n", output);
+
+    for (int i = 2; i < argc; i++) {
+        const char* name = strrchr(argv[i], '/') != NULL ? strrchr(argv[i], '/') + 1 : argv[i];
+        size_t name_length = strlen(name);
+        if (name_length > 3 && strcmp(name + name_length - 3, ".cj") == 0) {
+            name_length -= 3;
+        }
+
+        fprintf(output, "    {\"%.*s\", sizeof(module_%d_exports) / sizeof(module_%d_exports[0]), module_%d_exports},\n", (int) name_length, name, i - 2, i - 2, i - 2);
+    }
+
+    fputs("};\n", output);
+
+    cj_release_type_checking_process(&type_checking_process);
+    cj_release_parsing_process(&parsing_process);
+
+    if (fclose(output) != 0 || status != 0) {
+        remove(argv[1]);
+        return status != 0 ? status : 2;
+    }
+
+	return 0;
+}
@@ -0,0 +1,197 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "fold.h"
+#include "operator.h"
+#include "value.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+static bool cj_convert_literal_to_value(const struct cj_ast_tree_node* literal, struct cj_string* string, struct cj_value* value) {
+    const struct cj_ast_tree_node_children* children = cj_find_ast_tree_node_children(literal, "value");
+
+    switch (children->type) {
+        case STRING_TYPE:
+            string->length = strlen(children->string);
+            string->data = children->string;
+            value->type = STRING_VALUE;
+            value->string = string;
+            return true;
+
+        case NUMBER_TYPE:
+            value->type = NUMBER_VALUE;
+            value->number = (double) children->number;
+            return true;
+
+        case CHARACTER_TYPE:
+            value->type = CHARACTER_VALUE;
+            value->character = children->character;
+            return true;
+
+        case BOOLEAN_TYPE:
+            value->type = BOOLEAN_VALUE;
+            value->boolean = children->boolean;
+            return true;
+
+        case NULL_TYPE:
+            value->type = NULL_VALUE;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+static struct cj_ast_tree_node* cj_convert_value_to_literal(struct cj_arena* arena, struct cj_value value, const struct cj_ast_tree_node* origin, const struct cj_ast_tree_node* operand) {
+    if (value.type == STRING_VALUE) {
+        /* Only `&&` and `||` yield a string, and then it is one of the operands. */
+        return (struct cj_ast_tree_node*) operand;
+    }
+
+    struct cj_ast_tree_node* literal = cj_init_ast_tree_node(arena, "Literal");
+    if (literal == NULL) {
+        return NULL;
+    }
+    literal->start = origin->start;
+    literal->end = origin->end;
+
+    bool added;
+
+    switch (value.type) {
+        case NUMBER_VALUE:
+            added = cj_add_ast_tree_node_number_value(arena, literal, "value", value.number);
+            break;
+
+        case CHARACTER_VALUE:
+            added = cj_add_ast_tree_node_character_value(arena, literal, "value", value.character);
+            break;
+
+        case BOOLEAN_VALUE:
+            added = cj_add_ast_tree_node_boolean_value(arena, literal, "value", value.boolean);
+            break;
+
+        default:
+            added = cj_add_ast_tree_node_null_value(arena, literal, "value");
+            break;
+    }
+
+    return added ? literal : NULL;
+}
+
+/* Keeps the original node when the literal cannot be allocated. */
+static struct cj_ast_tree_node* cj_replace_folded_node(struct cj_arena* arena, struct cj_value value, struct cj_ast_tree_node* node, const struct cj_ast_tree_node* operand, size_t* folded) {
+    struct cj_ast_tree_node* literal = cj_convert_value_to_literal(arena, value, node, operand);
+    if (literal == NULL) {
+        return node;
+    }
+    (*folded)++;
+    return literal;
+}
+
+static bool cj_check_literal(const struct cj_ast_tree_node* node) {
+    return strcmp(node->type, "Literal") == 0;
+}
+
+static struct cj_ast_tree_node* cj_fold_binary_node(struct cj_arena* arena, struct cj_ast_tree_node* node, size_t* folded) {
+    const char* symbol = cj_find_ast_tree_node_children(node, "operator")->string;
+    struct cj_ast_tree_node* left_node = cj_find_ast_tree_node_children(node, "left")->node;
+    struct cj_ast_tree_node* right_node = cj_find_ast_tree_node_children(node, "right")->node;
+    struct cj_string left_string;
+    struct cj_string right_string;
+    struct cj_value left;
+    struct cj_value right;
+    struct cj_value result;
+
+    if (cj_check_literal(left_node) && cj_check_literal(right_node)
+            && cj_convert_literal_to_value(left_node, &left_string, &left)
+            && cj_convert_literal_to_value(right_node, &right_string, &right)
+            && cj_apply_binary_operator(cj_find_binary_operator(symbol, strlen(symbol)), left, right, &result)) {
+        const struct cj_ast_tree_node* operand = result.type == STRING_VALUE && result.string == &left_string ? left_node : right_node;
+        return cj_replace_folded_node(arena, result, node, operand, folded);
+    }
+    return node;
+}
+
+static struct cj_ast_tree_node* cj_fold_unary_node(struct cj_arena* arena, struct cj_ast_tree_node* node, size_t* folded) {
+    const char* symbol = cj_find_ast_tree_node_children(node, "operator")->string;
+    struct cj_ast_tree_node* argument_node = cj_find_ast_tree_node_children(node, "argument")->node;
+    struct cj_string string;
+    struct cj_value argument;
+    struct cj_value result;
+
+    if (cj_check_literal(argument_node)
+            && cj_convert_literal_to_value(argument_node, &string, &argument)
+            && cj_apply_unary_operator(cj_find_unary_operator(symbol, strlen(symbol)), argument, &result)) {
+        return cj_replace_folded_node(arena, result, node, argument_node, folded);
+    }
+    return node;
+}
+
+static struct cj_ast_tree_node* cj_fold_expression(struct cj_arena* arena, struct cj_ast_spine* spine, struct cj_ast_tree_node* node, size_t* folded);
+
+/* Folds a chain of binary expressions from the innermost one out, each
+ * taking the folded result of the previous one as its left operand. */
+static struct cj_ast_tree_node* cj_fold_binary_expression(struct cj_arena* arena, struct cj_ast_spine* spine, struct cj_ast_tree_node* binary_expression, size_t* folded) {
+    size_t spine_length = cj_push_ast_spine(spine, binary_expression);
+    struct cj_ast_tree_node_children* left = cj_find_ast_tree_node_children(spine->nodes[spine->length - 1], "left");
+    struct cj_ast_tree_node* result = cj_fold_expression(arena, spine, left->node, folded);
+
+    for (size_t i = spine->length; i-- > spine_length;) {
+        struct cj_ast_tree_node* node = (struct cj_ast_tree_node*) spine->nodes[i];
+        struct cj_ast_tree_node_children* right = cj_find_ast_tree_node_children(node, "right");
+
+        cj_find_ast_tree_node_children(node, "left")->node = result;
+        right->node = cj_fold_expression(arena, spine, right->node, folded);
+        result = cj_fold_binary_node(arena, node, folded);
+    }
+
+    cj_pop_ast_spine(spine, spine_length);
+    return result;
+}
+
+static struct cj_ast_tree_node* cj_fold_expression(struct cj_arena* arena, struct cj_ast_spine* spine, struct cj_ast_tree_node* node, size_t* folded) {
+    if (strcmp(node->type, "BinaryExpression") == 0) {
+        return cj_fold_binary_expression(arena, spine, node, folded);
+    }
+
+    for (size_t i = 0; i < node->childrens_length; i++) {
+        if (node->childrens[i]->type == NODE_TYPE) {
+            node->childrens[i]->node = cj_fold_expression(arena, spine, node->childrens[i]->node, folded);
+        }
+    }
+
+    if (strcmp(node->type, "UnaryExpression") == 0) {
+        return cj_fold_unary_node(arena, node, folded);
+    }
+    return node;
+}
+
+size_t cj_fold_constants(struct cj_arena* arena, struct cj_ast_tree_node* root) {
+    struct cj_ast_spine spine;
+    cj_init_ast_spine(&spine);
+
+    size_t folded = 0;
+    cj_fold_expression(arena, &spine, root, &folded);
+
+    cj_release_ast_spine(&spine);
+    return folded;
+}
@@ -19,23 +19,17 @@
  * THE SOFTWARE.
  */
 
-#ifndef CONJOINT_SRC_UTIL_H_
-#define CONJOINT_SRC_UTIL_H_
+#ifndef CONJOINT_SRC_FOLD_H_
+#define CONJOINT_SRC_FOLD_H_
 
-#include <stdlib.h>
-#include <wchar.h>
+#include "arena.h"
+#include "ast.h"
 
-#define cj_string_init(string, chunk_size) \
-    string = malloc(sizeof(wchar_t) * (chunk_size + 1)); \
-    assert(string); \
-    string[0] = '\0';
+#include <stddef.h>
 
-#define cj_string_append(string, character, length, chunk_size) \
-    if (length > 0 && length % chunk_size == 0) { \
-        string = realloc(string, sizeof(wchar_t) * (length + chunk_size + 1)); \
-        assert(string); \
-    } \
-    string[length++] = character; \
-    string[length] = '\0';
+/* Replaces unary and binary expressions whose operands are literals by the
+ * resulting literal. New nodes are allocated in `arena`, which should be the
+ * one the tree was parsed into. Returns the number of folded expressions. */
+size_t cj_fold_constants(struct cj_arena* arena, struct cj_ast_tree_node* root);
 
-#endif /* CONJOINT_SRC_UTIL_H_ */
+#endif /* CONJOINT_SRC_FOLD_H_ */
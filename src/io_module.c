@@ -0,0 +1,57 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "native_module.h"
+#include "value.h"
+#include "vm.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+static struct cj_value cj_io_print(struct cj_virtual_machine* machine, const struct cj_value* arguments, size_t arguments_length) {
+    assert(arguments_length == 1);
+    (void) arguments_length;
+
+    char buffer[CJ_VALUE_BUFFER_SIZE];
+    const char* data;
+    size_t length = cj_format_value(arguments[0], buffer, &data);
+    cj_write_output(machine, data, length);
+
+    struct cj_value result = {.type = NULL_VALUE};
+    return result;
+}
+
+static struct cj_value cj_io_print_line(struct cj_virtual_machine* machine, const struct cj_value* arguments, size_t arguments_length) {
+    struct cj_value result = cj_io_print(machine, arguments, arguments_length);
+    cj_write_output(machine, "\n", 1);
+    return result;
+}
+
+static const struct cj_native_export io_exports[] = {
+    {.name = "print", .arity = 1, .function = cj_io_print},
+    {.name = "printLine", .arity = 1, .function = cj_io_print_line}
+};
+
+const struct cj_native_module cj_io_module = {
+    .name = "io",
+    .exports_length = sizeof(io_exports) / sizeof(io_exports[0]),
+    .exports = io_exports
+};
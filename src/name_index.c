@@ -0,0 +1,623 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "name_index.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define CJ_NAME_INDEX_MAGIC "CJNI"
+#define CJ_NAME_INDEX_VERSION 3
+#define CJ_MAXIMUM_INDEXED_STRING_LENGTH 65536
+
+static bool cj_grow_array(struct cj_allocator* allocator, void** items, size_t* capacity, size_t length, size_t item_size) {
+    if (length < *capacity) {
+        return true;
+    }
+
+    size_t grown_capacity = *capacity > 0 ? *capacity * 2 : 64;
+    void* grown = cj_reallocate(allocator, NAME_INDEX_MEMORY, *items, item_size * *capacity, item_size * grown_capacity);
+    if (grown == NULL) {
+        return false;
+    }
+
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+static uint32_t cj_hash_name(const char* name, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char) name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static char* cj_copy_string(struct cj_allocator* allocator, const char* string, size_t length) {
+    char* copy = cj_allocate(allocator, NAME_INDEX_MEMORY, length + 1);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+static size_t* cj_find_name_slot(size_t* slots, size_t capacity, const struct cj_indexed_name* names, const char* name, size_t length, uint32_t hash) {
+    size_t slot = hash & (capacity - 1);
+    while (slots[slot] != 0) {
+        const struct cj_indexed_name* candidate = &names[slots[slot] - 1];
+        if (candidate->hash == hash && candidate->length == length && memcmp(candidate->name, name, length) == 0) {
+            break;
+        }
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return &slots[slot];
+}
+
+static bool cj_grow_name_slots(struct cj_name_index* index) {
+    size_t capacity = index->slots_capacity > 0 ? index->slots_capacity * 2 : 256;
+    size_t* slots = cj_allocate(index->allocator, NAME_INDEX_MEMORY, sizeof(size_t) * capacity);
+    if (slots == NULL) {
+        return false;
+    }
+    memset(slots, 0, sizeof(size_t) * capacity);
+
+    for (size_t i = 0; i < index->names_length; i++) {
+        const struct cj_indexed_name* name = &index->names[i];
+        *cj_find_name_slot(slots, capacity, index->names, name->name, name->length, name->hash) = i + 1;
+    }
+
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, index->slots, sizeof(size_t) * index->slots_capacity);
+    index->slots = slots;
+    index->slots_capacity = capacity;
+    return true;
+}
+
+/* Sets `interned` to the number of the name, adding it if needed. Returns
+ * false if memory runs out. */
+static bool cj_intern_indexed_name(struct cj_name_index* index, const char* name, size_t length, size_t* interned) {
+    uint32_t hash = cj_hash_name(name, length);
+
+    if (index->slots_capacity > 0) {
+        size_t slot = *cj_find_name_slot(index->slots, index->slots_capacity, index->names, name, length, hash);
+        if (slot != 0) {
+            *interned = slot - 1;
+            return true;
+        }
+    }
+
+    if ((index->names_length + 1) * 2 > index->slots_capacity && !cj_grow_name_slots(index)) {
+        return false;
+    }
+    if (!cj_grow_array(index->allocator, (void**) &index->names, &index->names_capacity, index->names_length, sizeof(struct cj_indexed_name))) {
+        return false;
+    }
+
+    char* copy = cj_copy_string(index->allocator, name, length);
+    if (copy == NULL) {
+        return false;
+    }
+
+    struct cj_indexed_name* indexed_name = &index->names[index->names_length++];
+    memset(indexed_name, 0, sizeof(struct cj_indexed_name));
+    indexed_name->name = copy;
+    indexed_name->length = length;
+    indexed_name->hash = hash;
+
+    *cj_find_name_slot(index->slots, index->slots_capacity, index->names, name, length, hash) = index->names_length;
+    *interned = index->names_length - 1;
+    return true;
+}
+
+static size_t* cj_find_file_slot(size_t* slots, size_t capacity, const struct cj_indexed_file* files, const char* path, uint32_t hash) {
+    size_t slot = hash & (capacity - 1);
+    while (slots[slot] != 0) {
+        const struct cj_indexed_file* candidate = &files[slots[slot] - 1];
+        if (candidate->hash == hash && strcmp(candidate->path, path) == 0) {
+            break;
+        }
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return &slots[slot];
+}
+
+static void cj_fill_file_slots(struct cj_name_index* index, size_t* slots, size_t capacity) {
+    memset(slots, 0, sizeof(size_t) * capacity);
+
+    for (size_t i = 0; i < index->files_length; i++) {
+        const struct cj_indexed_file* file = &index->files[i];
+        if (file->live) {
+            *cj_find_file_slot(slots, capacity, index->files, file->path, file->hash) = i + 1;
+        }
+    }
+}
+
+static bool cj_grow_file_slots(struct cj_name_index* index) {
+    size_t capacity = index->files_slots_capacity > 0 ? index->files_slots_capacity * 2 : 64;
+    size_t* slots = cj_allocate(index->allocator, NAME_INDEX_MEMORY, sizeof(size_t) * capacity);
+    if (slots == NULL) {
+        return false;
+    }
+
+    cj_fill_file_slots(index, slots, capacity);
+
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, index->files_slots, sizeof(size_t) * index->files_slots_capacity);
+    index->files_slots = slots;
+    index->files_slots_capacity = capacity;
+    return true;
+}
+
+void cj_init_name_index(struct cj_name_index* index, struct cj_allocator* allocator) {
+    memset(index, 0, sizeof(struct cj_name_index));
+    index->allocator = allocator;
+}
+
+static void cj_release_indexed_path(struct cj_name_index* index, char* path) {
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, path, strlen(path) + 1);
+}
+
+void cj_clear_name_index(struct cj_name_index* index) {
+    for (size_t i = 0; i < index->files_length; i++) {
+        cj_release_indexed_path(index, index->files[i].path);
+    }
+    for (size_t i = 0; i < index->names_length; i++) {
+        cj_deallocate(index->allocator, NAME_INDEX_MEMORY, (char*) index->names[i].name, index->names[i].length + 1);
+    }
+    if (index->files_slots != NULL) {
+        memset(index->files_slots, 0, sizeof(size_t) * index->files_slots_capacity);
+    }
+    if (index->slots != NULL) {
+        memset(index->slots, 0, sizeof(size_t) * index->slots_capacity);
+    }
+
+    index->files_length = 0;
+    index->names_length = 0;
+    index->sites_length = 0;
+    index->dead_sites_length = 0;
+}
+
+void cj_release_name_index(struct cj_name_index* index) {
+    cj_clear_name_index(index);
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, index->files, sizeof(struct cj_indexed_file) * index->files_capacity);
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, index->files_slots, sizeof(size_t) * index->files_slots_capacity);
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, index->names, sizeof(struct cj_indexed_name) * index->names_capacity);
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, index->slots, sizeof(size_t) * index->slots_capacity);
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, index->sites, sizeof(struct cj_name_site) * index->sites_capacity);
+    cj_init_name_index(index, index->allocator);
+}
+
+static void cj_chain_name_site(struct cj_name_index* index, size_t site) {
+    struct cj_indexed_name* name = &index->names[index->sites[site].name];
+    bool declaration = index->sites[site].type == DECLARATION_SITE;
+    size_t* first = declaration ? &name->first_declaration : &name->first_reference;
+    size_t* last = declaration ? &name->last_declaration : &name->last_reference;
+
+    index->sites[site].next = 0;
+    if (*last != 0) {
+        index->sites[*last - 1].next = site + 1;
+    } else {
+        *first = site + 1;
+    }
+    *last = site + 1;
+}
+
+static void cj_kill_indexed_file(struct cj_name_index* index, size_t file) {
+    struct cj_indexed_file* indexed_file = &index->files[file];
+
+    for (size_t i = 0; i < indexed_file->sites_length; i++) {
+        const struct cj_name_site* site = &index->sites[indexed_file->first_site + i];
+        if (site->type == DECLARATION_SITE) {
+            index->names[site->name].declarations_length--;
+        } else {
+            index->names[site->name].references_length--;
+        }
+    }
+
+    indexed_file->live = false;
+    index->dead_sites_length += indexed_file->sites_length;
+}
+
+/* Drops dead files and their sites, keeping the others in order, and chains
+ * the remaining sites again. */
+static void cj_compact_name_index(struct cj_name_index* index) {
+    size_t files_length = 0;
+    size_t sites_length = 0;
+
+    for (size_t i = 0; i < index->files_length; i++) {
+        struct cj_indexed_file file = index->files[i];
+        if (!file.live) {
+            cj_release_indexed_path(index, file.path);
+            continue;
+        }
+
+        memmove(&index->sites[sites_length], &index->sites[file.first_site], sizeof(struct cj_name_site) * file.sites_length);
+        for (size_t j = 0; j < file.sites_length; j++) {
+            index->sites[sites_length + j].file = files_length;
+        }
+        file.first_site = sites_length;
+        sites_length += file.sites_length;
+        index->files[files_length++] = file;
+    }
+
+    index->files_length = files_length;
+    index->sites_length = sites_length;
+    index->dead_sites_length = 0;
+
+    for (size_t i = 0; i < index->names_length; i++) {
+        struct cj_indexed_name* name = &index->names[i];
+        name->first_declaration = name->last_declaration = 0;
+        name->first_reference = name->last_reference = 0;
+    }
+    for (size_t i = 0; i < index->sites_length; i++) {
+        cj_chain_name_site(index, i);
+    }
+
+    cj_fill_file_slots(index, index->files_slots, index->files_slots_capacity);
+}
+
+bool cj_add_indexed_file(struct cj_name_index* index, const char* path, size_t* file) {
+    size_t length = strlen(path);
+    uint32_t hash = cj_hash_name(path, length);
+
+    /* Everything is allocated before the earlier sites are dropped, so a
+     * failure leaves the index as it was. */
+    char* copy = cj_copy_string(index->allocator, path, length);
+    if (copy == NULL) {
+        return false;
+    }
+    if (!cj_grow_array(index->allocator, (void**) &index->files, &index->files_capacity, index->files_length, sizeof(struct cj_indexed_file))
+            || ((index->files_length + 1) * 2 > index->files_slots_capacity && !cj_grow_file_slots(index))) {
+        cj_release_indexed_path(index, copy);
+        return false;
+    }
+
+    if (index->files_slots_capacity > 0) {
+        size_t slot = *cj_find_file_slot(index->files_slots, index->files_slots_capacity, index->files, path, hash);
+        if (slot != 0) {
+            cj_kill_indexed_file(index, slot - 1);
+            if (index->dead_sites_length > index->sites_length - index->dead_sites_length) {
+                cj_compact_name_index(index);
+            }
+        }
+    }
+
+    index->files[index->files_length++] = (struct cj_indexed_file) {
+        .path = copy,
+        .hash = hash,
+        .live = true,
+        .first_site = index->sites_length,
+        .sites_length = 0
+    };
+
+    *cj_find_file_slot(index->files_slots, index->files_slots_capacity, index->files, path, hash) = index->files_length;
+    *file = index->files_length - 1;
+    return true;
+}
+
+static bool cj_add_interned_name_site(struct cj_name_index* index, enum cj_name_site_type type, size_t name, size_t file, size_t start, size_t end) {
+    assert(file + 1 == index->files_length && index->files[file].live);
+
+    if (!cj_grow_array(index->allocator, (void**) &index->sites, &index->sites_capacity, index->sites_length, sizeof(struct cj_name_site))) {
+        return false;
+    }
+    index->sites[index->sites_length] = (struct cj_name_site) {
+        .type = type,
+        .name = name,
+        .file = file,
+        .start = start,
+        .end = end
+    };
+    cj_chain_name_site(index, index->sites_length++);
+    index->files[file].sites_length++;
+
+    if (type == DECLARATION_SITE) {
+        index->names[name].declarations_length++;
+    } else {
+        index->names[name].references_length++;
+    }
+    return true;
+}
+
+bool cj_add_name_site(struct cj_name_index* index, enum cj_name_site_type type, const char* name, size_t length, size_t file, size_t start, size_t end) {
+    size_t interned;
+    return cj_intern_indexed_name(index, name, length, &interned)
+        && cj_add_interned_name_site(index, type, interned, file, start, end);
+}
+
+const struct cj_indexed_name* cj_find_indexed_name(const struct cj_name_index* index, const char* name, size_t length) {
+    if (index->slots_capacity == 0) {
+        return NULL;
+    }
+
+    size_t slot = *cj_find_name_slot(index->slots, index->slots_capacity, index->names, name, length, cj_hash_name(name, length));
+    return slot != 0 ? &index->names[slot - 1] : NULL;
+}
+
+static const struct cj_name_site* cj_get_live_name_site(const struct cj_name_index* index, size_t site) {
+    while (site != 0 && !index->files[index->sites[site - 1].file].live) {
+        site = index->sites[site - 1].next;
+    }
+    return site != 0 ? &index->sites[site - 1] : NULL;
+}
+
+const struct cj_name_site* cj_get_first_name_site(const struct cj_name_index* index, const struct cj_indexed_name* name, enum cj_name_site_type type) {
+    return cj_get_live_name_site(index, type == DECLARATION_SITE ? name->first_declaration : name->first_reference);
+}
+
+const struct cj_name_site* cj_get_next_name_site(const struct cj_name_index* index, const struct cj_name_site* site) {
+    return cj_get_live_name_site(index, site->next);
+}
+
+bool cj_merge_name_index(struct cj_name_index* destination, const struct cj_name_index* source) {
+    for (size_t i = 0; i < source->files_length; i++) {
+        const struct cj_indexed_file* file = &source->files[i];
+        if (!file->live) {
+            continue;
+        }
+
+        size_t destination_file;
+        if (!cj_add_indexed_file(destination, file->path, &destination_file)) {
+            return false;
+        }
+        for (size_t j = 0; j < file->sites_length; j++) {
+            const struct cj_name_site* site = &source->sites[file->first_site + j];
+            const struct cj_indexed_name* name = &source->names[site->name];
+            if (!cj_add_name_site(destination, site->type, name->name, name->length, destination_file, site->start, site->end)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* The writers return the number of bytes they write. */
+static uint64_t cj_write_number(uint64_t number, FILE* stream) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char) (number >> (i * 8));
+    }
+    fwrite(bytes, 1, sizeof(bytes), stream);
+    return sizeof(bytes);
+}
+
+static bool cj_read_number(FILE* stream, uint64_t* number) {
+    unsigned char bytes[8];
+    if (fread(bytes, 1, sizeof(bytes), stream) != sizeof(bytes)) {
+        return false;
+    }
+
+    *number = 0;
+    for (int i = 0; i < 8; i++) {
+        *number |= (uint64_t) bytes[i] << (i * 8);
+    }
+    return true;
+}
+
+static uint64_t cj_write_string(const char* string, size_t length, FILE* stream) {
+    uint64_t written = cj_write_number(length, stream);
+    fwrite(string, 1, length, stream);
+    return written + length;
+}
+
+/* Returns a copy owned by the caller, of `length` plus one bytes, or NULL. */
+static char* cj_read_string(struct cj_allocator* allocator, FILE* stream, size_t* length) {
+    uint64_t string_length;
+    if (!cj_read_number(stream, &string_length) || string_length > CJ_MAXIMUM_INDEXED_STRING_LENGTH) {
+        return NULL;
+    }
+
+    char* string = cj_allocate(allocator, NAME_INDEX_MEMORY, (size_t) string_length + 1);
+    if (string == NULL) {
+        return NULL;
+    }
+    if (fread(string, 1, string_length, stream) != string_length) {
+        cj_deallocate(allocator, NAME_INDEX_MEMORY, string, (size_t) string_length + 1);
+        return NULL;
+    }
+
+    string[string_length] = '\0';
+    *length = string_length;
+    return string;
+}
+
+/* A segment is the path, the names its sites use and the sites, which
+ * refer to names by their position in that list. `local_names` maps index
+ * names to that position plus one and is left zeroed. */
+static uint64_t cj_write_name_index_segment(const struct cj_name_index* index, const struct cj_indexed_file* file, size_t* local_names, size_t* segment_names, FILE* stream) {
+    const struct cj_name_site* sites = &index->sites[file->first_site];
+    size_t names_length = 0;
+    uint64_t written = 0;
+
+    for (size_t i = 0; i < file->sites_length; i++) {
+        if (local_names[sites[i].name] == 0) {
+            segment_names[names_length++] = sites[i].name;
+            local_names[sites[i].name] = names_length;
+        }
+    }
+
+    written += cj_write_string(file->path, strlen(file->path), stream);
+    written += cj_write_number(names_length, stream);
+    for (size_t i = 0; i < names_length; i++) {
+        const struct cj_indexed_name* name = &index->names[segment_names[i]];
+        written += cj_write_string(name->name, name->length, stream);
+    }
+
+    written += cj_write_number(file->sites_length, stream);
+    for (size_t i = 0; i < file->sites_length; i++) {
+        written += cj_write_number(local_names[sites[i].name] - 1, stream);
+        written += cj_write_number(sites[i].type, stream);
+        written += cj_write_number(sites[i].start, stream);
+        written += cj_write_number(sites[i].end, stream);
+    }
+
+    for (size_t i = 0; i < names_length; i++) {
+        local_names[segment_names[i]] = 0;
+    }
+    return written;
+}
+
+static void cj_write_name_index_header(uint64_t written_length, uint64_t appended_length, FILE* stream) {
+    fwrite(CJ_NAME_INDEX_MAGIC, 1, 4, stream);
+    cj_write_number(CJ_NAME_INDEX_VERSION, stream);
+    cj_write_number(written_length, stream);
+    cj_write_number(appended_length, stream);
+}
+
+static bool cj_write_name_index_segments(const struct cj_name_index* index, FILE* stream, uint64_t* length) {
+    size_t size = sizeof(size_t) * (index->names_length + 1);
+    size_t* local_names = cj_allocate(index->allocator, NAME_INDEX_MEMORY, size);
+    size_t* segment_names = cj_allocate(index->allocator, NAME_INDEX_MEMORY, size);
+    bool appended = local_names != NULL && segment_names != NULL;
+
+    if (appended) {
+        memset(local_names, 0, size);
+        for (size_t i = 0; i < index->files_length; i++) {
+            if (index->files[i].live) {
+                *length += cj_write_name_index_segment(index, &index->files[i], local_names, segment_names, stream);
+            }
+        }
+    }
+
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, segment_names, size);
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, local_names, size);
+    return appended && !ferror(stream);
+}
+
+/* The length of the segments is only known once they are written, so the
+ * header is written again. A stream that can not seek keeps zero, which
+ * only makes the next update write the index again. */
+bool cj_write_name_index(const struct cj_name_index* index, FILE* stream) {
+    uint64_t length = 0;
+
+    cj_write_name_index_header(0, 0, stream);
+    if (!cj_write_name_index_segments(index, stream, &length)) {
+        return false;
+    }
+
+    if (fseek(stream, 0, SEEK_SET) == 0) {
+        cj_write_name_index_header(length, 0, stream);
+        fseek(stream, 0, SEEK_END);
+    }
+    return !ferror(stream);
+}
+
+bool cj_append_name_index(const struct cj_name_index* index, FILE* stream) {
+    uint64_t written_length, appended_length, length = 0;
+
+    if (fseek(stream, 0, SEEK_SET) != 0 || !cj_read_name_index_header(stream, &written_length, &appended_length)
+            || fseek(stream, 0, SEEK_END) != 0 || !cj_write_name_index_segments(index, stream, &length)
+            || fseek(stream, 0, SEEK_SET) != 0) {
+        return false;
+    }
+
+    cj_write_name_index_header(written_length, appended_length + length, stream);
+    return !ferror(stream);
+}
+
+bool cj_read_name_index_header(FILE* stream, uint64_t* written_length, uint64_t* appended_length) {
+    char magic[4];
+    uint64_t version;
+
+    return fread(magic, 1, 4, stream) == 4 && memcmp(magic, CJ_NAME_INDEX_MAGIC, 4) == 0
+        && cj_read_number(stream, &version) && version == CJ_NAME_INDEX_VERSION
+        && cj_read_number(stream, written_length) && cj_read_number(stream, appended_length);
+}
+
+static bool cj_read_name_index_segment(struct cj_name_index* index, FILE* stream, size_t** names, size_t* names_capacity) {
+    size_t length;
+    size_t file;
+    char* path = cj_read_string(index->allocator, stream, &length);
+    if (path == NULL) {
+        return false;
+    }
+    bool added = cj_add_indexed_file(index, path, &file);
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, path, length + 1);
+    if (!added) {
+        return false;
+    }
+
+    uint64_t names_length, sites_length;
+    if (!cj_read_number(stream, &names_length)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < names_length; i++) {
+        char* name = cj_read_string(index->allocator, stream, &length);
+        if (name == NULL) {
+            return false;
+        }
+        bool interned = cj_grow_array(index->allocator, (void**) names, names_capacity, (size_t) i, sizeof(size_t))
+            && cj_intern_indexed_name(index, name, length, &(*names)[i]);
+        cj_deallocate(index->allocator, NAME_INDEX_MEMORY, name, length + 1);
+        if (!interned) {
+            return false;
+        }
+    }
+
+    if (!cj_read_number(stream, &sites_length)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < sites_length; i++) {
+        uint64_t name, type, start, end;
+        if (!cj_read_number(stream, &name) || !cj_read_number(stream, &type) || !cj_read_number(stream, &start) || !cj_read_number(stream, &end)
+                || name >= names_length || type > REFERENCE_SITE || start > end) {
+            return false;
+        }
+        if (!cj_add_interned_name_site(index, (enum cj_name_site_type) type, (*names)[name], file, (size_t) start, (size_t) end)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool cj_read_name_index_content(struct cj_name_index* index, FILE* stream) {
+    uint64_t written_length, appended_length;
+    if (!cj_read_name_index_header(stream, &written_length, &appended_length)) {
+        return false;
+    }
+
+    size_t* names = NULL;
+    size_t names_capacity = 0;
+    bool read = true;
+    int next;
+
+    while (read && (next = fgetc(stream)) != EOF) {
+        ungetc(next, stream);
+        read = cj_read_name_index_segment(index, stream, &names, &names_capacity);
+    }
+
+    cj_deallocate(index->allocator, NAME_INDEX_MEMORY, names, sizeof(size_t) * names_capacity);
+    return read && !ferror(stream);
+}
+
+bool cj_read_name_index(struct cj_name_index* index, FILE* stream) {
+    cj_clear_name_index(index);
+
+    if (!cj_read_name_index_content(index, stream)) {
+        cj_clear_name_index(index);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,145 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_NAME_INDEX_H_
+#define CONJOINT_SRC_NAME_INDEX_H_
+
+#include "allocator.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+enum cj_name_site_type {
+    DECLARATION_SITE,
+    REFERENCE_SITE
+};
+
+/* `start` and `end` are content offsets of the identifier in `file`. Sites
+ * of a name are chained through `next`, which is an index plus one. */
+struct cj_name_site {
+    enum cj_name_site_type type;
+    size_t name;
+    size_t file;
+    size_t start;
+    size_t end;
+    size_t next;
+};
+
+/* The sites of a file are the `sites_length` ones from `first_site`. A file
+ * indexed again leaves a dead entry, skipped until the index is compacted. */
+struct cj_indexed_file {
+    char* path;
+    uint32_t hash;
+    bool live;
+    size_t first_site;
+    size_t sites_length;
+};
+
+struct cj_indexed_name {
+    const char* name;
+    size_t length;
+    uint32_t hash;
+
+    size_t declarations_length;
+    size_t first_declaration;
+    size_t last_declaration;
+
+    size_t references_length;
+    size_t first_reference;
+    size_t last_reference;
+};
+
+/* Declarations and references of names across any number of files. Names
+ * and paths are copied, so the index does not depend on the parse it was
+ * built from. Functions adding to it return false if the allocator fails,
+ * and what was indexed before stays usable. */
+struct cj_name_index {
+    struct cj_allocator* allocator;
+
+    size_t files_length;
+    size_t files_capacity;
+    struct cj_indexed_file* files;
+
+    /* Open addressing table of live file numbers plus one. */
+    size_t files_slots_capacity;
+    size_t* files_slots;
+
+    size_t names_length;
+    size_t names_capacity;
+    struct cj_indexed_name* names;
+
+    /* Open addressing table of name indexes plus one. */
+    size_t slots_capacity;
+    size_t* slots;
+
+    size_t sites_length;
+    size_t sites_capacity;
+    struct cj_name_site* sites;
+
+    /* Sites of dead files, compacted away once they outnumber the others. */
+    size_t dead_sites_length;
+};
+
+void cj_init_name_index(struct cj_name_index* index, struct cj_allocator* allocator);
+
+void cj_clear_name_index(struct cj_name_index* index);
+
+void cj_release_name_index(struct cj_name_index* index);
+
+/* Starts the sites of the file with this path and sets `file` to its number.
+ * The sites it had before are replaced, and the numbers of other files may
+ * change, so sites are added for that number before the next file is
+ * started. */
+bool cj_add_indexed_file(struct cj_name_index* index, const char* path, size_t* file);
+
+bool cj_add_name_site(struct cj_name_index* index, enum cj_name_site_type type, const char* name, size_t length, size_t file, size_t start, size_t end);
+
+const struct cj_indexed_name* cj_find_indexed_name(const struct cj_name_index* index, const char* name, size_t length);
+
+/* First declaration or reference of a name, or NULL, and the next one of
+ * the same kind. */
+const struct cj_name_site* cj_get_first_name_site(const struct cj_name_index* index, const struct cj_indexed_name* name, enum cj_name_site_type type);
+
+const struct cj_name_site* cj_get_next_name_site(const struct cj_name_index* index, const struct cj_name_site* site);
+
+/* Adds the files of `source` to `destination`. A file indexed in both keeps
+ * only the sites from `source`, so merging a reindexed file updates it. */
+bool cj_merge_name_index(struct cj_name_index* destination, const struct cj_name_index* source);
+
+/* An index is a header followed by one segment per file. The header holds
+ * the length of the segments written with it and of those appended since. */
+bool cj_write_name_index(const struct cj_name_index* index, FILE* stream);
+
+/* Adds the segments to a stored index, for a stream opened for update. */
+bool cj_append_name_index(const struct cj_name_index* index, FILE* stream);
+
+/* Returns whether the stream starts with a header of this index version,
+ * and reads the lengths it holds. */
+bool cj_read_name_index_header(FILE* stream, uint64_t* written_length, uint64_t* appended_length);
+
+/* Replaces the content of the index. A segment replaces the earlier ones of
+ * the same file. Returns false, leaving the index empty, if the stream is
+ * not a valid index or memory runs out. */
+bool cj_read_name_index(struct cj_name_index* index, FILE* stream);
+
+#endif /* CONJOINT_SRC_NAME_INDEX_H_ */
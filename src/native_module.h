@@ -0,0 +1,51 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_NATIVE_MODULE_H_
+#define CONJOINT_SRC_NATIVE_MODULE_H_
+
+#include "value.h"
+
+#include <stddef.h>
+
+struct cj_virtual_machine;
+
+typedef struct cj_value (*cj_native_function)(struct cj_virtual_machine* machine, const struct cj_value* arguments, size_t arguments_length);
+
+struct cj_native_export {
+    const char* name;
+    size_t arity;
+    cj_native_function function;
+};
+
+struct cj_native_module {
+    const char* name;
+    size_t exports_length;
+    const struct cj_native_export* exports;
+};
+
+extern const struct cj_native_module cj_io_module;
+
+const struct cj_native_module* cj_find_native_module(const char* name);
+
+const struct cj_native_export* cj_find_native_export(const struct cj_native_module* module, const char* name);
+
+#endif /* CONJOINT_SRC_NATIVE_MODULE_H_ */
@@ -0,0 +1,244 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "operator.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+const struct cj_operator_info cj_operators[] = {
+    {"||", 1},
+    {"&&", 2},
+    {"|", 3},
+    {"^", 4},
+    {"&", 5},
+    {"==", 6},
+    {"!=", 6},
+    {"<", 7},
+    {">", 7},
+    {"<<", 8},
+    {">>", 8},
+    {">>>", 8},
+    {"+", 9},
+    {"-", 9},
+    {"*", 10},
+    {"/", 10},
+    {"%", 10},
+    {"-", 0},
+    {"~", 0},
+    {"!", 0}
+};
+
+static bool cj_check_operator_symbol(enum cj_operator operator, const char* symbol, size_t length) {
+    return strlen(cj_operators[operator].symbol) == length && memcmp(cj_operators[operator].symbol, symbol, length) == 0;
+}
+
+enum cj_operator cj_find_binary_operator(const char* symbol, size_t length) {
+    for (enum cj_operator operator = LOGICAL_OR_OPERATOR; operator < NEGATE_OPERATOR; operator++) {
+        if (cj_check_operator_symbol(operator, symbol, length)) {
+            return operator;
+        }
+    }
+    return NO_OPERATOR;
+}
+
+enum cj_operator cj_find_unary_operator(const char* symbol, size_t length) {
+    for (enum cj_operator operator = NEGATE_OPERATOR; operator < NO_OPERATOR; operator++) {
+        if (cj_check_operator_symbol(operator, symbol, length)) {
+            return operator;
+        }
+    }
+    return NO_OPERATOR;
+}
+
+static int32_t cj_convert_to_int32(double number) {
+    if (!isfinite(number)) {
+        return 0;
+    }
+
+    double modulo = fmod(trunc(number), 4294967296.0);
+    if (modulo < 0) {
+        modulo += 4294967296.0;
+    }
+    return (int32_t) (uint32_t) modulo;
+}
+
+bool cj_check_values_equal(struct cj_value left, struct cj_value right) {
+    if (left.type != right.type) {
+        return false;
+    }
+
+    switch (left.type) {
+        case NULL_VALUE:
+            return true;
+
+        case BOOLEAN_VALUE:
+            return left.boolean == right.boolean;
+
+        case NUMBER_VALUE:
+            return left.number == right.number;
+
+        case CHARACTER_VALUE:
+            return left.character == right.character;
+
+        case STRING_VALUE:
+            return left.string->length == right.string->length
+                && memcmp(left.string->data, right.string->data, left.string->length) == 0;
+    }
+
+    return false;
+}
+
+bool cj_apply_binary_operator(enum cj_operator operator, struct cj_value left, struct cj_value right, struct cj_value* result) {
+    switch (operator) {
+        case LOGICAL_OR_OPERATOR:
+        case LOGICAL_AND_OPERATOR:
+            if (left.type != BOOLEAN_VALUE || right.type != BOOLEAN_VALUE) {
+                return false;
+            }
+            *result = left.boolean == (operator == LOGICAL_OR_OPERATOR) ? left : right;
+            return true;
+
+        case EQUAL_OPERATOR:
+        case NOT_EQUAL_OPERATOR:
+            result->type = BOOLEAN_VALUE;
+            result->boolean = cj_check_values_equal(left, right) == (operator == EQUAL_OPERATOR);
+            return true;
+
+        case LESS_OPERATOR:
+        case GREATER_OPERATOR:
+            if (left.type == CHARACTER_VALUE && right.type == CHARACTER_VALUE) {
+                result->type = BOOLEAN_VALUE;
+                result->boolean = operator == LESS_OPERATOR ? left.character < right.character : left.character > right.character;
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (left.type != NUMBER_VALUE || right.type != NUMBER_VALUE) {
+        return false;
+    }
+
+    double a = left.number;
+    double b = right.number;
+
+    switch (operator) {
+        case LESS_OPERATOR:
+            result->type = BOOLEAN_VALUE;
+            result->boolean = a < b;
+            return true;
+
+        case GREATER_OPERATOR:
+            result->type = BOOLEAN_VALUE;
+            result->boolean = a > b;
+            return true;
+
+        default:
+            break;
+    }
+
+    result->type = NUMBER_VALUE;
+
+    switch (operator) {
+        case BITWISE_OR_OPERATOR:
+            result->number = cj_convert_to_int32(a) | cj_convert_to_int32(b);
+            return true;
+
+        case BITWISE_XOR_OPERATOR:
+            result->number = cj_convert_to_int32(a) ^ cj_convert_to_int32(b);
+            return true;
+
+        case BITWISE_AND_OPERATOR:
+            result->number = cj_convert_to_int32(a) & cj_convert_to_int32(b);
+            return true;
+
+        case LEFT_SHIFT_OPERATOR:
+            result->number = (int32_t) ((uint32_t) cj_convert_to_int32(a) << (cj_convert_to_int32(b) & 31));
+            return true;
+
+        case RIGHT_SHIFT_OPERATOR:
+            result->number = cj_convert_to_int32(a) >> (cj_convert_to_int32(b) & 31);
+            return true;
+
+        case UNSIGNED_RIGHT_SHIFT_OPERATOR:
+            result->number = (uint32_t) cj_convert_to_int32(a) >> (cj_convert_to_int32(b) & 31);
+            return true;
+
+        case ADD_OPERATOR:
+            result->number = a + b;
+            return true;
+
+        case SUBTRACT_OPERATOR:
+            result->number = a - b;
+            return true;
+
+        case MULTIPLY_OPERATOR:
+            result->number = a * b;
+            return true;
+
+        case DIVIDE_OPERATOR:
+            result->number = a / b;
+            return true;
+
+        case REMAINDER_OPERATOR:
+            result->number = fmod(a, b);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool cj_apply_unary_operator(enum cj_operator operator, struct cj_value argument, struct cj_value* result) {
+    switch (operator) {
+        case NEGATE_OPERATOR:
+            if (argument.type != NUMBER_VALUE) {
+                return false;
+            }
+            result->type = NUMBER_VALUE;
+            result->number = -argument.number;
+            return true;
+
+        case BITWISE_NOT_OPERATOR:
+            if (argument.type != NUMBER_VALUE) {
+                return false;
+            }
+            result->type = NUMBER_VALUE;
+            result->number = ~cj_convert_to_int32(argument.number);
+            return true;
+
+        case LOGICAL_NOT_OPERATOR:
+            if (argument.type != BOOLEAN_VALUE) {
+                return false;
+            }
+            result->type = BOOLEAN_VALUE;
+            result->boolean = !argument.boolean;
+            return true;
+
+        default:
+            return false;
+    }
+}
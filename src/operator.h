@@ -0,0 +1,74 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_OPERATOR_H_
+#define CONJOINT_SRC_OPERATOR_H_
+
+#include "value.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+enum cj_operator {
+    LOGICAL_OR_OPERATOR,
+    LOGICAL_AND_OPERATOR,
+    BITWISE_OR_OPERATOR,
+    BITWISE_XOR_OPERATOR,
+    BITWISE_AND_OPERATOR,
+    EQUAL_OPERATOR,
+    NOT_EQUAL_OPERATOR,
+    LESS_OPERATOR,
+    GREATER_OPERATOR,
+    LEFT_SHIFT_OPERATOR,
+    RIGHT_SHIFT_OPERATOR,
+    UNSIGNED_RIGHT_SHIFT_OPERATOR,
+    ADD_OPERATOR,
+    SUBTRACT_OPERATOR,
+    MULTIPLY_OPERATOR,
+    DIVIDE_OPERATOR,
+    REMAINDER_OPERATOR,
+    NEGATE_OPERATOR,
+    BITWISE_NOT_OPERATOR,
+    LOGICAL_NOT_OPERATOR,
+    NO_OPERATOR
+};
+
+/* Binary operators have a precedence of 1 (loosest) and up, unary ones 0. */
+struct cj_operator_info {
+    const char* symbol;
+    int precedence;
+};
+
+extern const struct cj_operator_info cj_operators[];
+
+enum cj_operator cj_find_binary_operator(const char* symbol, size_t length);
+
+enum cj_operator cj_find_unary_operator(const char* symbol, size_t length);
+
+/* `&&` and `||` take two booleans and yield the right operand when it is not
+ * short-circuited. These return false on operand type errors. */
+bool cj_apply_binary_operator(enum cj_operator operator, struct cj_value left, struct cj_value right, struct cj_value* result);
+
+bool cj_apply_unary_operator(enum cj_operator operator, struct cj_value argument, struct cj_value* result);
+
+bool cj_check_values_equal(struct cj_value left, struct cj_value right);
+
+#endif /* CONJOINT_SRC_OPERATOR_H_ */
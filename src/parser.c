@@ -19,378 +19,563 @@
  * THE SOFTWARE.
  */
 
+#include "operator.h"
 #include "parser.h"
 #include "tokenizer.h"
+#include "utf8.h"
 
 #include <assert.h>
+#include <setjmp.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
-struct cj_ast_tree_node {
-    char* type;
-
-    int childrens_length;
-    struct cj_ast_tree_node_children** childrens;
-};
-
-enum cj_ast_tree_node_children_type {
-    NODE_TYPE,
-    STRING_TYPE,
-    NUMBER_TYPE,
-    CHARACTER_TYPE,
-    BOOLEAN_TYPE,
-    NULL_TYPE
-};
-
-struct cj_ast_tree_node_children {
-    enum cj_ast_tree_node_children_type type;
-
-    char* name;
-
-    union {
-        struct cj_ast_tree_node* node;
-        wchar_t* string;
-        long double number;
-        wchar_t character;
-        bool boolean;
-    };
-};
-
-struct cj_parsing_process {
-    struct cj_tokenization_process* tokenization_process;
-    struct cj_token* next_token;
-};
-
-static void cj_print_ast(struct cj_ast_tree_node* root, int level) {
-    char* indent = malloc(sizeof(char) * level * 4 + 1);
-    memset(indent, ' ', level * 4);
-    indent[level * 4] = '\0';
-    printf("%s", indent);
-    printf("TYPE: %s\n", root->type);
-    printf("%s", indent);
-    if (root->childrens_length > 0) {
-        printf("CHILDRENS:\n");
-        for (int i = 0; i < root->childrens_length; i++) {
-            printf("%s", indent);
-            printf("    %s:", root->childrens[i]->name);
-            switch (root->childrens[i]->type) {
-                case NODE_TYPE:
-                    printf("\n");
-                    cj_print_ast(root->childrens[i]->node, level + 2);
-                    break;
-
-                case STRING_TYPE:
-                    wprintf(L" \"%ls\"\n", root->childrens[i]->string);
-                    break;
-
-                case NUMBER_TYPE:
-                    wprintf(L" %Lf\n", root->childrens[i]->number);
-                    break;
-
-                case CHARACTER_TYPE:
-                    wprintf(L" '%lc'\n", root->childrens[i]->character);
-                    break;
-
-                case BOOLEAN_TYPE:
-                    if (root->childrens[i]->boolean) {
-                        printf(" true\n");
-                    } else {
-                        printf(" false\n");
-                    }
-                    break;
-
-                case NULL_TYPE:
-                    printf(" null\n");
-                    break;
-            }
-        }
-    } else {
-        printf("CHILDRENS: ~\n");
-    }
-    free(indent);
+#define CJ_MAXIMUM_EXPRESSION_DEPTH 512
+
+static void cj_report_error(struct cj_parsing_process* process, size_t position, const char* message) {
+    cj_report_diagnostic(&process->diagnostics, position, "%s", message);
+    longjmp(process->recovery_point, 1);
 }
 
-static struct cj_ast_tree_node* cj_init_ast_tree_node(char* type) {
-    struct cj_ast_tree_node* node = malloc(sizeof(struct cj_ast_tree_node));
-    node->type = type;
-    node->childrens_length = 0;
-    return node;
+static void cj_report_out_of_memory(struct cj_parsing_process* process) {
+    longjmp(process->recovery_point, CJ_OUT_OF_MEMORY);
 }
 
-static void cj_attach_ast_tree_node_children(struct cj_ast_tree_node* parent, struct cj_ast_tree_node_children *children) {
-    if (parent->childrens_length == 0) {
-        parent->childrens = malloc(sizeof(struct cj_ast_tree_node_children*));
+static void cj_report_unexpected_token(struct cj_parsing_process* process, const char* expected) {
+    size_t position = process->next_token.start;
+
+    if (process->next_token.type == ILLEGAL) {
+        cj_report_diagnostic(&process->diagnostics, position, "invalid token, expected %s", expected);
+    } else if (process->next_token.type == END_OF_FILE) {
+        cj_report_diagnostic(&process->diagnostics, position, "unexpected end of file, expected %s", expected);
     } else {
-        parent->childrens = realloc(parent->childrens, sizeof(struct cj_ast_tree_node_children*) * parent->childrens_length + 1);
+        int length = process->next_token.value_length < 16 ? (int) process->next_token.value_length : 16;
+        cj_report_diagnostic(&process->diagnostics, position, "unexpected `%.*s`, expected %s", length, process->next_token.value, expected);
     }
-    parent->childrens[parent->childrens_length++] = children;
-}
 
-static void cj_add_ast_tree_node_relation(struct cj_ast_tree_node* parent, struct cj_ast_tree_node* related, char* relation_name) {
-    struct cj_ast_tree_node_children* relation = malloc(sizeof(struct cj_ast_tree_node_children));
-    relation->type = NODE_TYPE;
-    relation->name = relation_name;
-    relation->node = related;
-    cj_attach_ast_tree_node_children(parent, relation);
+    longjmp(process->recovery_point, 1);
 }
 
-static void cj_add_ast_tree_node_string_value(struct cj_ast_tree_node* parent, char* relation_name, wchar_t* string) {
-    struct cj_ast_tree_node_children* relation = malloc(sizeof(struct cj_ast_tree_node_children));
-    relation->type = STRING_TYPE;
-    relation->name = relation_name;
-    relation->string = string;
-    cj_attach_ast_tree_node_children(parent, relation);
+static const char* cj_copy_token_value(struct cj_parsing_process* process) {
+    char* string = cj_arena_allocate(&process->arena, process->next_token.value_length + 1);
+    memcpy(string, process->next_token.value, process->next_token.value_length);
+    string[process->next_token.value_length] = '\0';
+    return string;
 }
 
-static void cj_add_ast_tree_node_character_value(struct cj_ast_tree_node* parent, char* relation_name, wchar_t character) {
-    struct cj_ast_tree_node_children* relation = malloc(sizeof(struct cj_ast_tree_node_children));
-    relation->type = CHARACTER_TYPE;
-    relation->name = relation_name;
-    relation->character = character;
-    cj_attach_ast_tree_node_children(parent, relation);
+static void cj_get_next_token(struct cj_parsing_process* process) {
+    process->previous_token_end = process->next_token.end;
+    cj_read_next_token(&process->tokenization_process, &process->next_token);
 }
 
-static void cj_add_ast_tree_node_boolean_value(struct cj_ast_tree_node* parent, char* relation_name, bool boolean) {
-    struct cj_ast_tree_node_children* relation = malloc(sizeof(struct cj_ast_tree_node_children));
-    relation->type = BOOLEAN_TYPE;
-    relation->name = relation_name;
-    relation->boolean = boolean;
-    cj_attach_ast_tree_node_children(parent, relation);
+static struct cj_ast_tree_node* cj_locate_ast_tree_node(struct cj_parsing_process* process, struct cj_ast_tree_node* node, size_t start) {
+    node->start = start;
+    node->end = process->previous_token_end;
+    return node;
 }
 
-static void cj_add_ast_tree_node_number_value(struct cj_ast_tree_node* parent, char* relation_name, long double number) {
-    struct cj_ast_tree_node_children* relation = malloc(sizeof(struct cj_ast_tree_node_children));
-    relation->type = NUMBER_TYPE;
-    relation->name = relation_name;
-    relation->number = number;
-    cj_attach_ast_tree_node_children(parent, relation);
+static bool cj_match_keyword(struct cj_parsing_process* process, const char* keyword) {
+    return process->next_token.type == KEYWORD && cj_check_token_value(&process->next_token, keyword);
 }
 
-static void cj_add_ast_tree_node_null_value(struct cj_ast_tree_node* parent, char* relation_name) {
-    struct cj_ast_tree_node_children* relation = malloc(sizeof(struct cj_ast_tree_node_children));
-    relation->type = NULL_TYPE;
-    relation->name = relation_name;
-    cj_attach_ast_tree_node_children(parent, relation);
+static bool cj_match_punctuator(struct cj_parsing_process* process, const char* punctuator) {
+    return process->next_token.type == PUNCTUATOR && cj_check_token_value(&process->next_token, punctuator);
 }
 
-static void cj_get_next_token(struct cj_parsing_process* process) {
-    if (process->next_token != NULL) {
-        cj_release_token(process->next_token);
+static void cj_expect_keyword(struct cj_parsing_process* process, const char* keyword) {
+    if (!cj_match_keyword(process, keyword)) {
+        char expected[16];
+        snprintf(expected, sizeof(expected), "`%s`", keyword);
+        cj_report_unexpected_token(process, expected);
     }
-    process->next_token = cj_read_next_token(process->tokenization_process);
+    cj_get_next_token(process);
 }
 
-static void cj_expect_keyword(struct cj_parsing_process* process, wchar_t* keyword) {
-    assert(process->next_token->type == KEYWORD);
-    assert(wcscmp(process->next_token->value, keyword) == 0);
+static void cj_expect_punctuator(struct cj_parsing_process* process, const char* punctuator) {
+    if (!cj_match_punctuator(process, punctuator)) {
+        char expected[16];
+        snprintf(expected, sizeof(expected), "`%s`", punctuator);
+        cj_report_unexpected_token(process, expected);
+    }
     cj_get_next_token(process);
 }
 
-static void cj_expect_punctuator(struct cj_parsing_process* process, wchar_t* punctuator) {
-    assert(process->next_token->type == PUNCTUATOR);
-    assert(wcscmp(process->next_token->value, punctuator) == 0);
-    cj_get_next_token(process);
+static void cj_index_identifier(struct cj_parsing_process* process, const struct cj_ast_tree_node* identifier, enum cj_name_site_type type) {
+    if (process->name_index != NULL) {
+        const char* name = cj_find_ast_tree_node_children(identifier, "value")->string;
+        if (!cj_add_name_site(process->name_index, type, name, strlen(name), process->name_index_file, identifier->start, identifier->end)) {
+            cj_report_out_of_memory(process);
+        }
+    }
 }
 
 static struct cj_ast_tree_node* cj_parse_comment(struct cj_parsing_process* process) {
-    assert(process->next_token->type == COMMENT);
-    struct cj_ast_tree_node* comment = cj_init_ast_tree_node("Comment");
-    cj_add_ast_tree_node_string_value(comment, "content", process->next_token->value);
+    assert(process->next_token.type == COMMENT);
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    size_t start = process->next_token.start;
+    struct cj_ast_tree_node* comment = cj_init_ast_tree_node(&process->arena, "Comment");
+    cj_add_ast_tree_node_string_value(&process->arena, comment, "content", cj_copy_token_value(process));
     cj_get_next_token(process);
-    return comment;
+    cj_leave_profiled(process, process->previous_token_end);
+    return cj_locate_ast_tree_node(process, comment, start);
 }
 
 static struct cj_ast_tree_node* cj_parse_identifier(struct cj_parsing_process* process) {
-    assert(process->next_token->type == IDENTIFIER);
-    struct cj_ast_tree_node* id = cj_init_ast_tree_node("Identifier");
-    cj_add_ast_tree_node_string_value(id, "value", process->next_token->value);
+    if (process->next_token.type != IDENTIFIER) {
+        cj_report_unexpected_token(process, "identifier");
+    }
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    size_t start = process->next_token.start;
+    struct cj_ast_tree_node* id = cj_init_ast_tree_node(&process->arena, "Identifier");
+    const char* name = cj_intern_symbol(&process->symbol_table, process->next_token.value, process->next_token.value_length);
+    if (name == NULL) {
+        cj_report_out_of_memory(process);
+    }
+    cj_add_ast_tree_node_string_value(&process->arena, id, "value", name);
     cj_get_next_token(process);
-    return id;
+    cj_leave_profiled(process, process->previous_token_end);
+    return cj_locate_ast_tree_node(process, id, start);
 }
 
 static struct cj_ast_tree_node* cj_parse_literal(struct cj_parsing_process* process) {
-    struct cj_ast_tree_node* literal = cj_init_ast_tree_node("Literal");
-    long double value;
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    size_t start = process->next_token.start;
+    struct cj_ast_tree_node* literal = cj_init_ast_tree_node(&process->arena, "Literal");
+    long double number = 0;
+    uint32_t character;
 
-    switch (process->next_token->type) {
+    switch (process->next_token.type) {
         case STRING_LITERAL:
-            cj_add_ast_tree_node_string_value(literal, "value", process->next_token->value);
+            cj_add_ast_tree_node_string_value(&process->arena, literal, "value", cj_copy_token_value(process));
             cj_get_next_token(process);
             break;
 
         case NUMERIC_LITERAL:
-            swscanf(process->next_token->value, L"%Lf", &value);
-            cj_add_ast_tree_node_number_value(literal, "value", value);
+            for (size_t i = 0; i < process->next_token.value_length; i++) {
+                number = number * 10 + (process->next_token.value[i] - '0');
+            }
+            cj_add_ast_tree_node_number_value(&process->arena, literal, "value", number);
             cj_get_next_token(process);
             break;
 
         case CHARACTER_LITERAL:
-            cj_add_ast_tree_node_character_value(literal, "value", process->next_token->value[0]);
+            cj_decode_utf8(process->next_token.value, process->next_token.value_length, &character);
+            cj_add_ast_tree_node_character_value(&process->arena, literal, "value", character);
             cj_get_next_token(process);
             break;
 
         case BOOLEAN_LITERAL:
-            cj_add_ast_tree_node_boolean_value(literal, "value", wcscmp(process->next_token->value, L"true") == 0);
+            cj_add_ast_tree_node_boolean_value(&process->arena, literal, "value", cj_check_token_value(&process->next_token, "true"));
             cj_get_next_token(process);
             break;
 
         case NULL_LITERAL:
-            cj_add_ast_tree_node_null_value(literal, "value");
+            cj_add_ast_tree_node_null_value(&process->arena, literal, "value");
             cj_get_next_token(process);
             break;
 
         default:
-            assert(NULL);
+            cj_report_unexpected_token(process, "literal");
     }
 
-    return literal;
+    cj_leave_profiled(process, process->previous_token_end);
+    return cj_locate_ast_tree_node(process, literal, start);
 }
 
-static bool cj_match_punctuator(struct cj_parsing_process* process, wchar_t* punctuator) {
-    return process->next_token->type == PUNCTUATOR && wcscmp(process->next_token->value, punctuator) == 0;
+static void cj_enter_expression(struct cj_parsing_process* process) {
+    if (++process->expression_depth > CJ_MAXIMUM_EXPRESSION_DEPTH) {
+        cj_report_error(process, process->next_token.start, "expression is too deeply nested");
+    }
+}
+
+static void cj_leave_expression(struct cj_parsing_process* process) {
+    process->expression_depth--;
 }
 
+static struct cj_ast_tree_node* cj_parse_expression(struct cj_parsing_process* process);
+
 static struct cj_ast_tree_node* cj_parse_primary_expression(struct cj_parsing_process* process) {
-    switch (process->next_token->type) {
+    struct cj_ast_tree_node* expression = NULL;
+    cj_enter_profiled(process, __func__, process->next_token.start);
+
+    switch (process->next_token.type) {
         case IDENTIFIER:
-            return cj_parse_identifier(process);
+            expression = cj_parse_identifier(process);
+            cj_index_identifier(process, expression, REFERENCE_SITE);
+            break;
 
         case STRING_LITERAL:
         case NUMERIC_LITERAL:
         case CHARACTER_LITERAL:
         case BOOLEAN_LITERAL:
         case NULL_LITERAL:
-            return cj_parse_literal(process);
+            expression = cj_parse_literal(process);
+            break;
+
+        case PUNCTUATOR:
+            if (cj_match_punctuator(process, "(")) {
+                cj_get_next_token(process);
+                expression = cj_parse_expression(process);
+                cj_expect_punctuator(process, ")");
+                break;
+            }
+            cj_report_unexpected_token(process, "expression");
+            break;
 
         default:
-            assert(NULL);
+            cj_report_unexpected_token(process, "expression");
+            break;
+    }
+
+    cj_leave_profiled(process, process->previous_token_end);
+    return expression;
+}
+
+static struct cj_ast_tree_node* cj_parse_call_expression(struct cj_parsing_process* process, struct cj_ast_tree_node* callee, size_t start) {
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    cj_expect_punctuator(process, "(");
+
+    struct cj_ast_tree_node* call_expression = cj_init_ast_tree_node(&process->arena, "CallExpression");
+    cj_add_ast_tree_node_relation(&process->arena, call_expression, callee, "callee");
+
+    if (!cj_match_punctuator(process, ")")) {
+        while (1) {
+            struct cj_ast_tree_node* argument = cj_parse_expression(process);
+            cj_add_ast_tree_node_relation(&process->arena, call_expression, argument, "argument");
+
+            if (cj_match_punctuator(process, ",")) {
+                cj_get_next_token(process);
+            } else {
+                break;
+            }
+        }
+    }
+
+    cj_expect_punctuator(process, ")");
+
+    cj_locate_ast_tree_node(process, call_expression, start);
+    cj_leave_profiled(process, process->previous_token_end);
+    return call_expression;
+}
+
+static struct cj_ast_tree_node* cj_parse_left_hand_side_expression(struct cj_parsing_process* process) {
+    size_t start = process->next_token.start;
+    struct cj_ast_tree_node* expression = cj_parse_primary_expression(process);
+    size_t depth = process->expression_depth;
+
+    /* Each call nests the previous one as its callee. */
+    while (cj_match_punctuator(process, "(")) {
+        cj_enter_expression(process);
+        expression = cj_parse_call_expression(process, expression, start);
+    }
+
+    process->expression_depth = depth;
+    return expression;
+}
+
+static struct cj_ast_tree_node* cj_parse_unary_expression(struct cj_parsing_process* process) {
+    enum cj_operator operator = NO_OPERATOR;
+
+    if (process->next_token.type == PUNCTUATOR) {
+        operator = cj_find_unary_operator(process->next_token.value, process->next_token.value_length);
+    }
+
+    if (operator == NO_OPERATOR) {
+        return cj_parse_left_hand_side_expression(process);
+    }
+
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    size_t start = process->next_token.start;
+    cj_enter_expression(process);
+    cj_get_next_token(process);
+
+    struct cj_ast_tree_node* unary_expression = cj_init_ast_tree_node(&process->arena, "UnaryExpression");
+    cj_add_ast_tree_node_string_value(&process->arena, unary_expression, "operator", cj_operators[operator].symbol);
+
+    struct cj_ast_tree_node* argument = cj_parse_unary_expression(process);
+    cj_add_ast_tree_node_relation(&process->arena, unary_expression, argument, "argument");
+
+    cj_leave_expression(process);
+    cj_locate_ast_tree_node(process, unary_expression, start);
+    cj_leave_profiled(process, process->previous_token_end);
+    return unary_expression;
+}
+
+/* Precedence climbing: operators looser than `minimum_precedence` are left
+ * for the caller, equal ones associate to the left. */
+static struct cj_ast_tree_node* cj_parse_binary_expression(struct cj_parsing_process* process, int minimum_precedence) {
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    size_t start = process->next_token.start;
+    struct cj_ast_tree_node* left = cj_parse_unary_expression(process);
+
+    while (process->next_token.type == PUNCTUATOR) {
+        enum cj_operator operator = cj_find_binary_operator(process->next_token.value, process->next_token.value_length);
+
+        if (operator == NO_OPERATOR || cj_operators[operator].precedence < minimum_precedence) {
+            break;
+        }
+
+        cj_get_next_token(process);
+
+        struct cj_ast_tree_node* binary_expression = cj_init_ast_tree_node(&process->arena, "BinaryExpression");
+        cj_add_ast_tree_node_string_value(&process->arena, binary_expression, "operator", cj_operators[operator].symbol);
+        cj_add_ast_tree_node_relation(&process->arena, binary_expression, left, "left");
+
+        struct cj_ast_tree_node* right = cj_parse_binary_expression(process, cj_operators[operator].precedence + 1);
+        cj_add_ast_tree_node_relation(&process->arena, binary_expression, right, "right");
+
+        left = cj_locate_ast_tree_node(process, binary_expression, start);
     }
+
+    cj_leave_profiled(process, process->previous_token_end);
+    return left;
+}
+
+static struct cj_ast_tree_node* cj_parse_expression(struct cj_parsing_process* process) {
+    cj_enter_expression(process);
+    struct cj_ast_tree_node* expression = cj_parse_binary_expression(process, 1);
+    cj_leave_expression(process);
+    return expression;
 }
 
 static struct cj_ast_tree_node* cj_parse_import_declaration(struct cj_parsing_process* process) {
-    cj_expect_keyword(process, L"import");
-    cj_expect_punctuator(process, L"{");
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    size_t start = process->next_token.start;
+    cj_expect_keyword(process, "import");
+    cj_expect_punctuator(process, "{");
 
-    struct cj_ast_tree_node* import_declaration = cj_init_ast_tree_node("ImportDeclaration");
+    struct cj_ast_tree_node* import_declaration = cj_init_ast_tree_node(&process->arena, "ImportDeclaration");
 
     while (1) {
         struct cj_ast_tree_node* specifier = cj_parse_identifier(process);
-        cj_add_ast_tree_node_relation(import_declaration, specifier, "specifier");
+        cj_index_identifier(process, specifier, DECLARATION_SITE);
+        cj_add_ast_tree_node_relation(&process->arena, import_declaration, specifier, "specifier");
 
-        if (cj_match_punctuator(process, L",")) {
+        if (cj_match_punctuator(process, ",")) {
             cj_get_next_token(process);
         } else {
             break;
         }
     }
 
-    cj_expect_punctuator(process, L"}");
-    cj_expect_keyword(process, L"from");
+    cj_expect_punctuator(process, "}");
+    cj_expect_keyword(process, "from");
 
-    assert(process->next_token->type == STRING_LITERAL);
+    if (process->next_token.type != STRING_LITERAL) {
+        cj_report_unexpected_token(process, "module name");
+    }
     struct cj_ast_tree_node* source = cj_parse_literal(process);
-    cj_add_ast_tree_node_relation(import_declaration, source, "source");
+    cj_add_ast_tree_node_relation(&process->arena, import_declaration, source, "source");
 
-    cj_expect_punctuator(process, L";");
+    cj_expect_punctuator(process, ";");
 
-    return import_declaration;
+    cj_leave_profiled(process, process->previous_token_end);
+    return cj_locate_ast_tree_node(process, import_declaration, start);
 }
 
 static struct cj_ast_tree_node* cj_parse_variable_declaration(struct cj_parsing_process* process) {
-    cj_expect_keyword(process, L"let");
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    size_t start = process->next_token.start;
+    cj_expect_keyword(process, "let");
 
-    struct cj_ast_tree_node* variable_declaration = cj_init_ast_tree_node("VariableDeclaration");
+    struct cj_ast_tree_node* variable_declaration = cj_init_ast_tree_node(&process->arena, "VariableDeclaration");
 
     struct cj_ast_tree_node* id = cj_parse_identifier(process);
-    cj_add_ast_tree_node_relation(variable_declaration, id, "id");
+    cj_index_identifier(process, id, DECLARATION_SITE);
+    cj_add_ast_tree_node_relation(&process->arena, variable_declaration, id, "id");
 
-    cj_expect_punctuator(process, L":");
+    cj_expect_punctuator(process, ":");
 
     struct cj_ast_tree_node* type = cj_parse_identifier(process);
-    cj_add_ast_tree_node_relation(variable_declaration, type, "type");
+    cj_add_ast_tree_node_relation(&process->arena, variable_declaration, type, "type");
 
-    if (cj_match_punctuator(process, L"?")) {
+    if (cj_match_punctuator(process, "?")) {
         cj_get_next_token(process);
-        cj_add_ast_tree_node_boolean_value(variable_declaration, "optional", true);
+        cj_add_ast_tree_node_boolean_value(&process->arena, variable_declaration, "optional", true);
     } else {
-        cj_add_ast_tree_node_boolean_value(variable_declaration, "optional", false);
+        cj_add_ast_tree_node_boolean_value(&process->arena, variable_declaration, "optional", false);
     }
 
-    cj_expect_punctuator(process, L"=");
+    cj_expect_punctuator(process, "=");
 
-    struct cj_ast_tree_node* init = cj_parse_primary_expression(process);
-    cj_add_ast_tree_node_relation(variable_declaration, init, "init");
+    struct cj_ast_tree_node* init = cj_parse_expression(process);
+    cj_add_ast_tree_node_relation(&process->arena, variable_declaration, init, "init");
 
-    cj_expect_punctuator(process, L";");
+    cj_expect_punctuator(process, ";");
 
-    return variable_declaration;
+    cj_leave_profiled(process, process->previous_token_end);
+    return cj_locate_ast_tree_node(process, variable_declaration, start);
+}
+
+static struct cj_ast_tree_node* cj_parse_expression_statement(struct cj_parsing_process* process) {
+    cj_enter_profiled(process, __func__, process->next_token.start);
+    size_t start = process->next_token.start;
+
+    struct cj_ast_tree_node* expression_statement = cj_init_ast_tree_node(&process->arena, "ExpressionStatement");
+
+    struct cj_ast_tree_node* expression = cj_parse_expression(process);
+    cj_add_ast_tree_node_relation(&process->arena, expression_statement, expression, "expression");
+
+    cj_expect_punctuator(process, ";");
+
+    cj_leave_profiled(process, process->previous_token_end);
+    return cj_locate_ast_tree_node(process, expression_statement, start);
 }
 
 static struct cj_ast_tree_node* cj_parse_program_element(struct cj_parsing_process* process) {
-    if (process->next_token->type == COMMENT) {
+    if (process->next_token.type == COMMENT) {
         return cj_parse_comment(process);
-    } else if (process->next_token->type == KEYWORD) {
-        if (wcscmp(process->next_token->value, L"import") == 0) {
-            return cj_parse_import_declaration(process);
-        } else if (wcscmp(process->next_token->value, L"let") == 0) {
-            return cj_parse_variable_declaration(process);
+    } else if (cj_match_keyword(process, "import")) {
+        return cj_parse_import_declaration(process);
+    } else if (cj_match_keyword(process, "let")) {
+        return cj_parse_variable_declaration(process);
+    }
+
+    return cj_parse_expression_statement(process);
+}
+
+static void cj_skip_program_element(struct cj_parsing_process* process) {
+    while (process->next_token.type != END_OF_FILE) {
+        if (cj_match_punctuator(process, ";")) {
+            cj_get_next_token(process);
+            return;
+        }
+
+        if (cj_match_keyword(process, "import") || cj_match_keyword(process, "let")) {
+            return;
+        }
+
+        cj_get_next_token(process);
+    }
+}
+
+static void cj_stop_parsing_out_of_memory(struct cj_parsing_process* process) {
+    process->out_of_memory = true;
+    cj_report_diagnostic(&process->diagnostics, process->next_token.start, "out of memory");
+}
+
+static bool cj_continue_parsing(struct cj_parsing_process* process) {
+    return !process->out_of_memory && process->next_token.type != END_OF_FILE;
+}
+
+/* Parses one program element. On a syntax error the diagnostic is recorded,
+ * the rest of the element is skipped and NULL is returned. Running out of
+ * memory also returns NULL, and stops the parse. */
+static struct cj_ast_tree_node* cj_try_parse_program_element(struct cj_parsing_process* process) {
+    process->expression_depth = 0;
+    size_t profiled_depth = cj_get_profiled_depth(process);
+
+    int status = setjmp(process->recovery_point);
+    if (status != 0) {
+        process->arena.failure_point = NULL;
+        cj_unwind_profiled(process, profiled_depth, process->previous_token_end);
+        if (status == CJ_OUT_OF_MEMORY) {
+            cj_stop_parsing_out_of_memory(process);
+        } else {
+            cj_skip_program_element(process);
         }
+        return NULL;
     }
 
-    return NULL;
+    process->arena.failure_point = &process->recovery_point;
+    struct cj_ast_tree_node* program_element = cj_parse_program_element(process);
+    process->arena.failure_point = NULL;
+    return program_element;
 }
 
 static struct cj_ast_tree_node* cj_parse_program(struct cj_parsing_process* process) {
-    struct cj_ast_tree_node* program = cj_init_ast_tree_node("Program");
+    struct cj_ast_tree_node* program = cj_init_ast_tree_node(&process->arena, "Program");
+    if (program == NULL) {
+        cj_stop_parsing_out_of_memory(process);
+        return NULL;
+    }
 
-    while (process->next_token->type != END_OF_FILE) {
-        struct cj_ast_tree_node* program_element = cj_parse_program_element(process);
-        cj_add_ast_tree_node_relation(program, program_element, "body");
+    while (cj_continue_parsing(process)) {
+        struct cj_ast_tree_node* program_element = cj_try_parse_program_element(process);
+        if (program_element != NULL && !cj_add_ast_tree_node_relation(&process->arena, program, program_element, "body")) {
+            cj_stop_parsing_out_of_memory(process);
+        }
     }
 
-    return program;
+    if (process->out_of_memory) {
+        return NULL;
+    }
+
+    return cj_locate_ast_tree_node(process, program, 0);
 }
 
-void cj_free_ast_tree_node(struct cj_ast_tree_node* node) {
-    for (int i = 0; i < node->childrens_length; i++) {
-//        free(node->childrens[i]->name);
-        switch (node->childrens[i]->type) {
-            case NODE_TYPE:
-                cj_free_ast_tree_node(node->childrens[i]->node);
-                break;
+static void cj_start_parsing(struct cj_parsing_process* process, struct cj_source_file* source_file) {
+    cj_reset_parsing_process(process);
 
-            case STRING_TYPE:
-                //free(node->childrens[i]->value.string);
-                break;
+    process->tokenization_process.source_file = source_file;
+    process->tokenization_process.current_position = 0;
 
-            default:
-                break;
-        }
-        free(node->childrens[i]);
+    if (!source_file->validated && !cj_validate_utf8(source_file->content, source_file->content_length)) {
+        cj_report_diagnostic(&process->diagnostics, 0, "source is not valid UTF-8");
+        process->next_token.type = END_OF_FILE;
+        process->next_token.start = 0;
+        process->next_token.end = 0;
+        return;
+    }
+
+#ifdef CJ_PROFILE
+    process->tokenization_process.profiling_process = process->profiling_process;
+#endif
+    process->next_token.end = 0;
+
+    cj_get_next_token(process);
+
+    if (process->name_index != NULL
+            && !cj_add_indexed_file(process->name_index, source_file->path != NULL ? source_file->path : "", &process->name_index_file)) {
+        cj_stop_parsing_out_of_memory(process);
     }
-    free(node->childrens);
-    free(node);
 }
 
-void cj_parse(struct cj_source_file* source_file) {
-    struct cj_tokenization_process tokenization_process = {
-        .source_file = source_file,
-        .current_position = 0,
-        .current_line_number = 0,
-        .current_line_start_position = 0
-    };
+void cj_init_parsing_process(struct cj_parsing_process* process, struct cj_allocator* allocator) {
+    process->tokenization_process.source_file = NULL;
+    process->name_index = NULL;
+    process->name_index_file = 0;
+#ifdef CJ_PROFILE
+    process->profiling_process = NULL;
+#endif
+    process->out_of_memory = false;
+    cj_init_arena(&process->arena, allocator, SYNTAX_TREE_MEMORY);
+    cj_init_symbol_table(&process->symbol_table, allocator);
+    cj_init_diagnostic_list(&process->diagnostics, allocator);
+}
 
-    struct cj_parsing_process parsing_process = {
-        .tokenization_process = &tokenization_process
-    };
+void cj_reset_parsing_process(struct cj_parsing_process* process) {
+    process->out_of_memory = false;
+    cj_reset_arena(&process->arena);
+    cj_clear_symbol_table(&process->symbol_table);
+    cj_clear_diagnostic_list(&process->diagnostics);
+}
+
+void cj_release_parsing_process(struct cj_parsing_process* process) {
+    cj_release_arena(&process->arena);
+    cj_release_symbol_table(&process->symbol_table);
+    cj_release_diagnostic_list(&process->diagnostics);
+}
 
-    cj_get_next_token(&parsing_process);
+struct cj_ast_tree_node* cj_parse(struct cj_parsing_process* process, struct cj_source_file* source_file) {
+    cj_start_parsing(process, source_file);
+    return cj_parse_program(process);
+}
 
-    struct cj_ast_tree_node* program = cj_parse_program(&parsing_process);
-//    cj_print_ast(program, 0);
+void cj_parse_program_elements(struct cj_parsing_process* process, struct cj_source_file* source_file, cj_program_element_visitor visitor, void* data) {
+    cj_start_parsing(process, source_file);
 
-    cj_free_ast_tree_node(program);
-    cj_release_token(parsing_process.next_token);
+    struct cj_arena_mark mark = cj_mark_arena(&process->arena);
+    struct cj_symbol_table_mark symbols_mark = cj_mark_symbol_table(&process->symbol_table);
+
+    while (cj_continue_parsing(process)) {
+        struct cj_ast_tree_node* program_element = cj_try_parse_program_element(process);
+        if (program_element != NULL) {
+            visitor(program_element, data);
+        }
+        cj_rewind_arena(&process->arena, mark);
+        cj_rewind_symbol_table(&process->symbol_table, symbols_mark);
+    }
 }
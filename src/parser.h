@@ -22,8 +22,71 @@
 #ifndef CONJOINT_SRC_PARSER_H_
 #define CONJOINT_SRC_PARSER_H_
 
+#include "arena.h"
+#include "ast.h"
+#include "diagnostic.h"
+#include "name_index.h"
+#include "profiler.h"
 #include "source_file.h"
+#include "symbol_table.h"
+#include "tokenizer.h"
 
-void cj_parse(struct cj_source_file* source_file);
+#include <setjmp.h>
+#include <stdbool.h>
+
+/* Parser context. It is meant to be initialized once and reused for any
+ * number of inputs: the node arena, the token buffer, the symbol table and
+ * the diagnostics storage are all kept between parses. Their contents,
+ * interned names included, only last until the next parse. */
+struct cj_parsing_process {
+    struct cj_tokenization_process tokenization_process;
+    struct cj_token next_token;
+    size_t previous_token_end;
+
+    /* Nesting of the expression being parsed, through parentheses, unary
+     * operators and calls. It is bounded so that recursive passes over the
+     * tree stay within a fixed stack depth; the length of a chain of binary
+     * operators is not, as passes walk chains in a loop (see cj_ast_spine). */
+    size_t expression_depth;
+
+    struct cj_arena arena;
+    struct cj_symbol_table symbol_table;
+
+    struct cj_diagnostic_list diagnostics;
+
+    /* Receives the declarations and references of the next parses, if set,
+     * with `name_index_file` the number of the file being parsed. */
+    struct cj_name_index* name_index;
+    size_t name_index_file;
+
+    /* Set when the allocator failed during the last parse. The parse stops
+     * there and cj_parse returns NULL. */
+    bool out_of_memory;
+
+    jmp_buf recovery_point;
+
+#ifdef CJ_PROFILE
+    /* Receives the rules and scanners run by the next parses, if set. */
+    struct cj_profiling_process* profiling_process;
+#endif
+};
+
+/* Called for every top-level element of a program. The element and the
+ * names it interned are released as soon as the visitor returns, so neither
+ * must be retained. */
+typedef void (*cj_program_element_visitor)(struct cj_ast_tree_node* element, void* data);
+
+void cj_init_parsing_process(struct cj_parsing_process* process, struct cj_allocator* allocator);
+
+void cj_reset_parsing_process(struct cj_parsing_process* process);
+
+void cj_release_parsing_process(struct cj_parsing_process* process);
+
+/* Parses the whole source into a Program node. The tree, its names and the
+ * diagnostics stay valid until the process is reset or used for the next
+ * parse. Returns NULL only when out of memory. */
+struct cj_ast_tree_node* cj_parse(struct cj_parsing_process* process, struct cj_source_file* source_file);
+
+void cj_parse_program_elements(struct cj_parsing_process* process, struct cj_source_file* source_file, cj_program_element_visitor visitor, void* data);
 
 #endif /* CONJOINT_SRC_PARSER_H_ */
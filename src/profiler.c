@@ -0,0 +1,274 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifdef CJ_PROFILE
+
+#include "profiler.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static uint64_t cj_read_cycle_counter(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000 + (uint64_t) time.tv_nsec;
+#endif
+}
+
+static void cj_grow_array(void** items, size_t* capacity, size_t length, size_t item_size) {
+    if (length == *capacity) {
+        *capacity = *capacity > 0 ? *capacity * 2 : 64;
+        *items = realloc(*items, item_size * *capacity);
+        assert(*items);
+    }
+}
+
+static size_t cj_find_profiled_rule(struct cj_profiling_process* process, const char* name) {
+    for (size_t i = 0; i < process->rules_length; i++) {
+        if (process->rules[i].name == name || strcmp(process->rules[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    cj_grow_array((void**) &process->rules, &process->rules_capacity, process->rules_length, sizeof(struct cj_profiled_rule));
+    process->rules[process->rules_length] = (struct cj_profiled_rule) {
+        .name = name
+    };
+    return process->rules_length++;
+}
+
+static size_t cj_find_profiled_stack(struct cj_profiling_process* process, size_t parent, size_t rule) {
+    size_t child = process->stacks[parent].first_child;
+
+    while (child != 0) {
+        if (process->stacks[child].rule == rule) {
+            return child;
+        }
+        child = process->stacks[child].next_sibling;
+    }
+
+    cj_grow_array((void**) &process->stacks, &process->stacks_capacity, process->stacks_length, sizeof(struct cj_profiled_stack));
+    process->stacks[process->stacks_length] = (struct cj_profiled_stack) {
+        .rule = rule,
+        .parent = parent,
+        .next_sibling = process->stacks[parent].first_child
+    };
+    process->stacks[parent].first_child = process->stacks_length;
+    return process->stacks_length++;
+}
+
+static void cj_swap_profiled_regions(struct cj_profiled_region* regions, size_t left, size_t right) {
+    struct cj_profiled_region region = regions[left];
+    regions[left] = regions[right];
+    regions[right] = region;
+}
+
+static void cj_keep_profiled_region(struct cj_profiling_process* process, struct cj_profiled_region region) {
+    struct cj_profiled_region* regions = process->regions;
+    size_t i;
+
+    if (process->regions_length < process->regions_capacity) {
+        i = process->regions_length++;
+        regions[i] = region;
+
+        while (i > 0 && regions[(i - 1) / 2].self_cycles > regions[i].self_cycles) {
+            cj_swap_profiled_regions(regions, i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+        return;
+    }
+
+    if (process->regions_length == 0 || region.self_cycles <= regions[0].self_cycles) {
+        return;
+    }
+
+    regions[0] = region;
+    i = 0;
+    for (;;) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < process->regions_length && regions[left].self_cycles < regions[smallest].self_cycles) {
+            smallest = left;
+        }
+        if (right < process->regions_length && regions[right].self_cycles < regions[smallest].self_cycles) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        cj_swap_profiled_regions(regions, i, smallest);
+        i = smallest;
+    }
+}
+
+void cj_init_profiling_process(struct cj_profiling_process* process, size_t regions_capacity) {
+    memset(process, 0, sizeof(struct cj_profiling_process));
+    if (regions_capacity > 0) {
+        process->regions = malloc(sizeof(struct cj_profiled_region) * regions_capacity);
+        assert(process->regions);
+        process->regions_capacity = regions_capacity;
+    }
+    cj_reset_profiling_process(process);
+}
+
+void cj_reset_profiling_process(struct cj_profiling_process* process) {
+    process->rules_length = 0;
+    process->regions_length = 0;
+    process->frames_length = 0;
+
+    cj_grow_array((void**) &process->stacks, &process->stacks_capacity, 0, sizeof(struct cj_profiled_stack));
+    process->stacks[0] = (struct cj_profiled_stack) { 0 };
+    process->stacks_length = 1;
+}
+
+void cj_release_profiling_process(struct cj_profiling_process* process) {
+    free(process->rules);
+    free(process->stacks);
+    free(process->regions);
+    free(process->frames);
+    memset(process, 0, sizeof(struct cj_profiling_process));
+}
+
+void cj_enter_profiled_rule(struct cj_profiling_process* process, const char* rule, size_t position) {
+    if (process == NULL) {
+        return;
+    }
+
+    size_t parent = process->frames_length > 0 ? process->frames[process->frames_length - 1].stack : 0;
+    size_t stack = cj_find_profiled_stack(process, parent, cj_find_profiled_rule(process, rule));
+
+    cj_grow_array((void**) &process->frames, &process->frames_capacity, process->frames_length, sizeof(struct cj_profiled_frame));
+    process->frames[process->frames_length++] = (struct cj_profiled_frame) {
+        .stack = stack,
+        .start = position,
+        .entry_cycles = cj_read_cycle_counter()
+    };
+}
+
+void cj_leave_profiled_rule(struct cj_profiling_process* process, size_t position) {
+    if (process == NULL) {
+        return;
+    }
+
+    assert(process->frames_length > 0);
+    const struct cj_profiled_frame* frame = &process->frames[--process->frames_length];
+    uint64_t cycles = cj_read_cycle_counter() - frame->entry_cycles;
+    uint64_t self_cycles = cycles > frame->children_cycles ? cycles - frame->children_cycles : 0;
+
+    struct cj_profiled_stack* stack = &process->stacks[frame->stack];
+    stack->self_cycles += self_cycles;
+    process->rules[stack->rule].calls++;
+    process->rules[stack->rule].self_cycles += self_cycles;
+
+    cj_keep_profiled_region(process, (struct cj_profiled_region) {
+        .rule = stack->rule,
+        .start = frame->start,
+        .end = position > frame->start ? position : frame->start,
+        .self_cycles = self_cycles
+    });
+
+    if (process->frames_length > 0) {
+        process->frames[process->frames_length - 1].children_cycles += cycles;
+    }
+}
+
+void cj_unwind_profiled_rules(struct cj_profiling_process* process, size_t depth, size_t position) {
+    while (process != NULL && process->frames_length > depth) {
+        cj_leave_profiled_rule(process, position);
+    }
+}
+
+static void cj_write_folded_stack(const struct cj_profiling_process* process, size_t stack, FILE* stream) {
+    if (process->stacks[stack].parent != 0) {
+        cj_write_folded_stack(process, process->stacks[stack].parent, stream);
+        fputc(';', stream);
+    }
+    fputs(process->rules[process->stacks[stack].rule].name, stream);
+}
+
+void cj_write_folded_stacks(const struct cj_profiling_process* process, FILE* stream) {
+    for (size_t i = 1; i < process->stacks_length; i++) {
+        if (process->stacks[i].self_cycles > 0) {
+            cj_write_folded_stack(process, i, stream);
+            fprintf(stream, " %llu\n", (unsigned long long) process->stacks[i].self_cycles);
+        }
+    }
+}
+
+static int cj_compare_profiled_rules(const void* left, const void* right) {
+    uint64_t left_cycles = (*(const struct cj_profiled_rule* const*) left)->self_cycles;
+    uint64_t right_cycles = (*(const struct cj_profiled_rule* const*) right)->self_cycles;
+    return (left_cycles < right_cycles) - (left_cycles > right_cycles);
+}
+
+static int cj_compare_profiled_regions(const void* left, const void* right) {
+    uint64_t left_cycles = ((const struct cj_profiled_region*) left)->self_cycles;
+    uint64_t right_cycles = ((const struct cj_profiled_region*) right)->self_cycles;
+    return (left_cycles < right_cycles) - (left_cycles > right_cycles);
+}
+
+void cj_print_profile_report(const struct cj_profiling_process* process, struct cj_source_file* source_file, FILE* stream) {
+    uint64_t total_cycles = 0;
+    const struct cj_profiled_rule** rules = malloc(sizeof(const struct cj_profiled_rule*) * (process->rules_length + 1));
+    assert(rules);
+
+    for (size_t i = 0; i < process->rules_length; i++) {
+        rules[i] = &process->rules[i];
+        total_cycles += process->rules[i].self_cycles;
+    }
+    qsort(rules, process->rules_length, sizeof(const struct cj_profiled_rule*), cj_compare_profiled_rules);
+
+    fprintf(stream, "%-32s %10s %14s %7s\n", "rule", "calls", "self cycles", "self %");
+    for (size_t i = 0; i < process->rules_length; i++) {
+        fprintf(stream, "%-32s %10zu %14llu %6.1f%%\n", rules[i]->name, rules[i]->calls, (unsigned long long) rules[i]->self_cycles,
+            total_cycles > 0 ? 100.0 * rules[i]->self_cycles / total_cycles : 0.0);
+    }
+    free(rules);
+
+    /* Sorting a copy keeps the heap intact for the caller. */
+    struct cj_profiled_region* regions = malloc(sizeof(struct cj_profiled_region) * (process->regions_length + 1));
+    assert(regions);
+    memcpy(regions, process->regions, sizeof(struct cj_profiled_region) * process->regions_length);
+    qsort(regions, process->regions_length, sizeof(struct cj_profiled_region), cj_compare_profiled_regions);
+
+    fprintf(stream, "\n%-24s %-32s %14s\n", "region", "rule", "self cycles");
+    for (size_t i = 0; i < process->regions_length; i++) {
+        struct cj_source_position start = cj_locate_source_position(source_file, regions[i].start);
+        struct cj_source_position end = cj_locate_source_position(source_file, regions[i].end);
+        char range[64];
+        snprintf(range, sizeof(range), "%zu:%zu-%zu:%zu", start.line + 1, start.column + 1, end.line + 1, end.column + 1);
+        fprintf(stream, "%-24s %-32s %14llu\n", range, process->rules[regions[i].rule].name, (unsigned long long) regions[i].self_cycles);
+    }
+    free(regions);
+}
+
+#endif /* CJ_PROFILE */
@@ -0,0 +1,136 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_PROFILER_H_
+#define CONJOINT_SRC_PROFILER_H_
+
+/* Grammar rule profiler, compiled in with -DCJ_PROFILE. The macros take a
+ * process with a `profiling_process` member, which the parsing and
+ * tokenization processes only have in that build. Without it the macros
+ * expand to nothing. */
+
+#ifdef CJ_PROFILE
+
+#include "source_file.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct cj_profiled_rule {
+    const char* name;
+    size_t calls;
+    uint64_t self_cycles;
+};
+
+/* Node of the tree of distinct call stacks. The first node is the root,
+ * which stands for the empty stack. */
+struct cj_profiled_stack {
+    size_t rule;
+    size_t parent;
+    size_t first_child;
+    size_t next_sibling;
+    uint64_t self_cycles;
+};
+
+/* One completed rule invocation and the content bytes it consumed. */
+struct cj_profiled_region {
+    size_t rule;
+    size_t start;
+    size_t end;
+    uint64_t self_cycles;
+};
+
+struct cj_profiled_frame {
+    size_t stack;
+    size_t start;
+    uint64_t entry_cycles;
+    uint64_t children_cycles;
+};
+
+struct cj_profiling_process {
+    size_t rules_length;
+    size_t rules_capacity;
+    struct cj_profiled_rule* rules;
+
+    size_t stacks_length;
+    size_t stacks_capacity;
+    struct cj_profiled_stack* stacks;
+
+    /* Min-heap on self cycles of the slowest `regions_capacity`
+     * invocations, so the cheapest of them is replaced first. */
+    size_t regions_length;
+    size_t regions_capacity;
+    struct cj_profiled_region* regions;
+
+    size_t frames_length;
+    size_t frames_capacity;
+    struct cj_profiled_frame* frames;
+};
+
+/* Only the `regions_capacity` invocations with the most self cycles are
+ * kept for the report. */
+void cj_init_profiling_process(struct cj_profiling_process* process, size_t regions_capacity);
+
+void cj_reset_profiling_process(struct cj_profiling_process* process);
+
+void cj_release_profiling_process(struct cj_profiling_process* process);
+
+/* `rule` is compared by address first, so string literals and __func__ are
+ * the intended names. A NULL process is ignored. */
+void cj_enter_profiled_rule(struct cj_profiling_process* process, const char* rule, size_t position);
+
+void cj_leave_profiled_rule(struct cj_profiling_process* process, size_t position);
+
+/* Leaves the rules entered above `depth`, for callers that longjmp out of
+ * them. */
+void cj_unwind_profiled_rules(struct cj_profiling_process* process, size_t depth, size_t position);
+
+/* One `rule;rule;rule cycles` line per distinct stack, as consumed by
+ * flamegraph.pl. */
+void cj_write_folded_stacks(const struct cj_profiling_process* process, FILE* stream);
+
+/* Cycles per rule, then the kept invocations with the most self cycles first
+ * and the source range each one covered. */
+void cj_print_profile_report(const struct cj_profiling_process* process, struct cj_source_file* source_file, FILE* stream);
+
+#define cj_enter_profiled(process, rule, position) \
+    cj_enter_profiled_rule((process)->profiling_process, rule, position)
+
+#define cj_leave_profiled(process, position) \
+    cj_leave_profiled_rule((process)->profiling_process, position)
+
+#define cj_get_profiled_depth(process) \
+    ((process)->profiling_process != NULL ? (process)->profiling_process->frames_length : 0)
+
+#define cj_unwind_profiled(process, depth, position) \
+    cj_unwind_profiled_rules((process)->profiling_process, depth, position)
+
+#else
+
+#define cj_enter_profiled(process, rule, position) ((void) 0)
+#define cj_leave_profiled(process, position) ((void) 0)
+#define cj_get_profiled_depth(process) ((size_t) 0)
+#define cj_unwind_profiled(process, depth, position) ((void) (depth))
+
+#endif /* CJ_PROFILE */
+
+#endif /* CONJOINT_SRC_PROFILER_H_ */
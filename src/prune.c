@@ -0,0 +1,272 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "prune.h"
+#include "native_module.h"
+#include "standard_module.h"
+
+#include <string.h>
+
+static bool cj_grow_array(struct cj_allocator* allocator, void** items, size_t* capacity, size_t length, size_t item_size) {
+    if (length < *capacity) {
+        return true;
+    }
+
+    size_t grown_capacity = *capacity > 0 ? *capacity * 2 : 64;
+    void* grown = cj_reallocate(allocator, GENERAL_MEMORY, *items, item_size * *capacity, item_size * grown_capacity);
+    if (grown == NULL) {
+        return false;
+    }
+
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+static const char* cj_get_identifier_name(const struct cj_ast_tree_node* identifier) {
+    return cj_find_ast_tree_node_children(identifier, "value")->string;
+}
+
+static bool cj_define_name(struct cj_pruning_process* process, enum cj_binding_type type, const char* name) {
+    if (cj_add_binding(&process->bindings, type, name, process->definitions_length) != BINDING_ADDED
+            || !cj_grow_array(process->allocator, (void**) &process->live_definitions, &process->definitions_capacity, process->definitions_length, sizeof(bool))) {
+        return false;
+    }
+
+    process->live_definitions[process->definitions_length++] = false;
+    return true;
+}
+
+static bool cj_record_references(struct cj_pruning_process* process, const struct cj_ast_tree_node* expression) {
+    /* References are only collected, not ordered, so the left operands of a
+     * chain are walked in a loop. */
+    while (strcmp(expression->type, "BinaryExpression") == 0) {
+        if (!cj_record_references(process, cj_find_ast_tree_node_children(expression, "right")->node)) {
+            return false;
+        }
+        expression = cj_find_ast_tree_node_children(expression, "left")->node;
+    }
+
+    if (strcmp(expression->type, "Identifier") == 0) {
+        const struct cj_binding* binding = cj_find_binding(&process->bindings, cj_get_identifier_name(expression));
+        if (binding == NULL) {
+            return false;
+        }
+
+        if (!cj_grow_array(process->allocator, (void**) &process->references, &process->references_capacity, process->references_length, sizeof(size_t))) {
+            return false;
+        }
+        process->references[process->references_length++] = binding->index;
+        return true;
+    }
+
+    for (size_t i = 0; i < expression->childrens_length; i++) {
+        if (expression->childrens[i]->type == NODE_TYPE && !cj_record_references(process, expression->childrens[i]->node)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool cj_check_module_export(const struct cj_native_module* module, const struct cj_standard_module* standard_module, const char* name) {
+    if (module != NULL) {
+        return cj_find_native_export(module, name) != NULL;
+    }
+    return cj_find_standard_export(standard_module, name) != NULL;
+}
+
+static bool cj_record_import_declaration(struct cj_pruning_process* process, const struct cj_ast_tree_node* import_declaration) {
+    const struct cj_ast_tree_node* source = cj_find_ast_tree_node_children(import_declaration, "source")->node;
+    const char* module_name = cj_find_ast_tree_node_children(source, "value")->string;
+    const struct cj_native_module* module = cj_find_native_module(module_name);
+    const struct cj_standard_module* standard_module = module == NULL ? cj_find_standard_module(module_name) : NULL;
+
+    if (module == NULL && standard_module == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < import_declaration->childrens_length; i++) {
+        if (strcmp(import_declaration->childrens[i]->name, "specifier") != 0) {
+            continue;
+        }
+
+        const char* name = cj_get_identifier_name(import_declaration->childrens[i]->node);
+        enum cj_binding_type type = module != NULL ? NATIVE_BINDING : VARIABLE_BINDING;
+        if (!cj_check_module_export(module, standard_module, name) || !cj_define_name(process, type, name)) {
+            return false;
+        }
+        process->statistics.specifiers++;
+    }
+    return true;
+}
+
+/* Collects the definitions and references of every element, in program
+ * order, so that names resolve exactly as in the backends. */
+static bool cj_record_program(struct cj_pruning_process* process, const struct cj_ast_tree_node* root) {
+    for (size_t i = 0; i < root->childrens_length; i++) {
+        const struct cj_ast_tree_node* element = root->childrens[i]->node;
+
+        if (!cj_grow_array(process->allocator, (void**) &process->elements, &process->elements_capacity, process->elements_length, sizeof(struct cj_pruned_element))) {
+            return false;
+        }
+        struct cj_pruned_element* record = &process->elements[process->elements_length++];
+        record->definitions_start = process->definitions_length;
+        record->references_start = process->references_length;
+
+        bool recorded = true;
+
+        if (strcmp(element->type, "ImportDeclaration") == 0) {
+            recorded = cj_record_import_declaration(process, element);
+        } else if (strcmp(element->type, "VariableDeclaration") == 0) {
+            const struct cj_ast_tree_node* id = cj_find_ast_tree_node_children(element, "id")->node;
+            const struct cj_ast_tree_node* init = cj_find_ast_tree_node_children(element, "init")->node;
+            recorded = cj_record_references(process, init) && cj_define_name(process, VARIABLE_BINDING, cj_get_identifier_name(id));
+            process->statistics.declarations++;
+        } else if (strcmp(element->type, "ExpressionStatement") == 0) {
+            recorded = cj_record_references(process, cj_find_ast_tree_node_children(element, "expression")->node);
+        }
+
+        if (!recorded) {
+            return false;
+        }
+        record->references_length = process->references_length - record->references_start;
+    }
+    return true;
+}
+
+/* Literals and variables are the initializers that can neither have effects
+ * nor fail at run time. Programs are type checked before being pruned, so a
+ * removed initializer can not hide a value the declared type does not
+ * accept. */
+static bool cj_check_pure_initializer(const struct cj_pruning_process* process, const struct cj_ast_tree_node* init) {
+    if (strcmp(init->type, "Literal") == 0) {
+        return true;
+    } else if (strcmp(init->type, "Identifier") == 0) {
+        return cj_find_binding(&process->bindings, cj_get_identifier_name(init))->type == VARIABLE_BINDING;
+    }
+    return false;
+}
+
+static bool cj_check_removable_declaration(const struct cj_pruning_process* process, const struct cj_ast_tree_node* element, const struct cj_pruned_element* record) {
+    return strcmp(element->type, "VariableDeclaration") == 0
+        && !process->live_definitions[record->definitions_start]
+        && cj_check_pure_initializer(process, cj_find_ast_tree_node_children(element, "init")->node);
+}
+
+/* Definitions precede their uses, so a single backward walk sees every use
+ * of a definition from a live element before reaching it. */
+static void cj_mark_live_definitions(struct cj_pruning_process* process, const struct cj_ast_tree_node* root) {
+    for (size_t i = root->childrens_length; i-- > 0;) {
+        const struct cj_ast_tree_node* element = root->childrens[i]->node;
+        const struct cj_pruned_element* record = &process->elements[i];
+
+        if (cj_check_removable_declaration(process, element, record)) {
+            continue;
+        }
+
+        for (size_t j = 0; j < record->references_length; j++) {
+            process->live_definitions[process->references[record->references_start + j]] = true;
+        }
+    }
+}
+
+/* Returns false if no specifier is left. */
+static bool cj_prune_import_declaration(struct cj_pruning_process* process, struct cj_ast_tree_node* import_declaration, const struct cj_pruned_element* record) {
+    size_t definition = record->definitions_start;
+    size_t kept = 0;
+    size_t specifiers_kept = 0;
+
+    for (size_t i = 0; i < import_declaration->childrens_length; i++) {
+        struct cj_ast_tree_node_children* children = import_declaration->childrens[i];
+
+        if (strcmp(children->name, "specifier") == 0) {
+            if (!process->live_definitions[definition++]) {
+                process->statistics.removed_specifiers++;
+                continue;
+            }
+            specifiers_kept++;
+        }
+        import_declaration->childrens[kept++] = children;
+    }
+
+    import_declaration->childrens_length = kept;
+    return specifiers_kept > 0;
+}
+
+void cj_init_pruning_process(struct cj_pruning_process* process, struct cj_allocator* allocator) {
+    memset(process, 0, sizeof(struct cj_pruning_process));
+    process->allocator = allocator;
+    cj_init_binding_table(&process->bindings, allocator);
+}
+
+void cj_release_pruning_process(struct cj_pruning_process* process) {
+    struct cj_allocator* allocator = process->allocator;
+    cj_release_binding_table(&process->bindings);
+    cj_deallocate(allocator, GENERAL_MEMORY, process->elements, sizeof(struct cj_pruned_element) * process->elements_capacity);
+    cj_deallocate(allocator, GENERAL_MEMORY, process->references, sizeof(size_t) * process->references_capacity);
+    cj_deallocate(allocator, GENERAL_MEMORY, process->live_definitions, sizeof(bool) * process->definitions_capacity);
+    memset(process, 0, sizeof(struct cj_pruning_process));
+    process->allocator = allocator;
+}
+
+bool cj_prune_program(struct cj_pruning_process* process, struct cj_ast_tree_node* root) {
+    cj_clear_binding_table(&process->bindings);
+    process->elements_length = 0;
+    process->references_length = 0;
+    process->definitions_length = 0;
+    memset(&process->statistics, 0, sizeof(struct cj_pruning_statistics));
+
+    if (!cj_record_program(process, root)) {
+        memset(&process->statistics, 0, sizeof(struct cj_pruning_statistics));
+        return false;
+    }
+
+    cj_mark_live_definitions(process, root);
+
+    size_t kept = 0;
+
+    for (size_t i = 0; i < root->childrens_length; i++) {
+        struct cj_ast_tree_node* element = root->childrens[i]->node;
+        const struct cj_pruned_element* record = &process->elements[i];
+
+        if (cj_check_removable_declaration(process, element, record)) {
+            process->statistics.removed_declarations++;
+            continue;
+        }
+
+        if (strcmp(element->type, "ImportDeclaration") == 0 && !cj_prune_import_declaration(process, element, record)) {
+            process->statistics.removed_imports++;
+            continue;
+        }
+
+        root->childrens[kept++] = root->childrens[i];
+    }
+
+    root->childrens_length = kept;
+    return true;
+}
+
+void cj_print_pruning_statistics(const struct cj_pruning_statistics* statistics, FILE* stream) {
+    fprintf(stream, "Removed %zu of %zu declarations, %zu of %zu import specifiers and %zu imports\n",
+        statistics->removed_declarations, statistics->declarations,
+        statistics->removed_specifiers, statistics->specifiers,
+        statistics->removed_imports);
+}
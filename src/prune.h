@@ -0,0 +1,84 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_PRUNE_H_
+#define CONJOINT_SRC_PRUNE_H_
+
+#include "ast.h"
+#include "binding_table.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+struct cj_pruning_statistics {
+    size_t declarations;
+    size_t removed_declarations;
+    size_t specifiers;
+    size_t removed_specifiers;
+    size_t removed_imports;
+};
+
+/* Where the definitions and references of a program element start in the
+ * process arrays. */
+struct cj_pruned_element {
+    size_t definitions_start;
+    size_t references_start;
+    size_t references_length;
+};
+
+/* Removes the declarations and import specifiers of a Program tree that
+ * nothing references, and the imports left without specifiers. Like the
+ * other processes it can be reused for many programs. */
+struct cj_pruning_process {
+    struct cj_allocator* allocator;
+    struct cj_binding_table bindings;
+
+    size_t elements_length;
+    size_t elements_capacity;
+    struct cj_pruned_element* elements;
+
+    /* Definition indexes, in the order the elements reference them. */
+    size_t references_length;
+    size_t references_capacity;
+    size_t* references;
+
+    size_t definitions_length;
+    size_t definitions_capacity;
+    bool* live_definitions;
+
+    struct cj_pruning_statistics statistics;
+};
+
+void cj_init_pruning_process(struct cj_pruning_process* process, struct cj_allocator* allocator);
+
+void cj_release_pruning_process(struct cj_pruning_process* process);
+
+/* Only declarations initialized with a literal or a variable are removed,
+ * other initializers may have effects or fail at run time. The tree is left
+ * untouched, and false returned, when a name or module does not resolve or
+ * is declared twice, so that the backends still report it, or when memory
+ * runs out. */
+bool cj_prune_program(struct cj_pruning_process* process, struct cj_ast_tree_node* root);
+
+void cj_print_pruning_statistics(const struct cj_pruning_statistics* statistics, FILE* stream);
+
+#endif /* CONJOINT_SRC_PRUNE_H_ */
@@ -19,36 +19,230 @@
  * THE SOFTWARE.
  */
 
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "source_file.h"
-#include "util.h"
+#include "utf8.h"
 
 #include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
-#include <wchar.h>
+#include <string.h>
+#include <sys/types.h>
+
+/* ftell returns a long, which is 32 bits wide on LLP64 targets. Returns
+ * false if the size is not known, which leaves the buffer to grow. */
+static bool cj_measure_source_file(FILE* handle, uint64_t* size) {
+#ifdef _WIN32
+    if (_fseeki64(handle, 0, SEEK_END) != 0) {
+        return false;
+    }
+    __int64 end = _ftelli64(handle);
+#else
+    if (fseeko(handle, 0, SEEK_END) != 0) {
+        return false;
+    }
+    off_t end = ftello(handle);
+#endif
+    rewind(handle);
+
+    if (end < 0) {
+        return false;
+    }
+    *size = (uint64_t) end;
+    return true;
+}
 
 int cj_read_source_file(struct cj_source_file* source_file) {
 	assert(source_file->path);
+    source_file->validated = false;
 
-	FILE* handle = fopen(source_file->path, "r");
+	FILE* handle = fopen(source_file->path, "rb");
 
 	if (!handle) {
         return -1;
     }
 
-	wchar_t character;
-    cj_string_init(source_file->content, 512);
+    struct cj_allocator* allocator = source_file->allocator;
+
+    size_t capacity = 4096;
+    uint64_t size;
+    if (cj_measure_source_file(handle, &size) && size > 0) {
+        if (size >= SIZE_MAX) {
+            fclose(handle);
+            return -3;
+        }
+        capacity = (size_t) size + 1;
+    }
+
+    source_file->content = cj_allocate(allocator, SOURCE_FILE_MEMORY, capacity);
+    source_file->content_capacity = capacity;
+    source_file->content_length = 0;
+
+    if (source_file->content == NULL) {
+        fclose(handle);
+        source_file->content_capacity = 0;
+        return -3;
+    }
 
 	while (1) {
-		character = fgetwc(handle);
+        if (source_file->content_length == capacity) {
+            char* content = cj_reallocate(allocator, SOURCE_FILE_MEMORY, source_file->content, capacity, capacity * 2);
+            if (content == NULL) {
+                fclose(handle);
+                cj_release_source_file(source_file);
+                return -3;
+            }
+            capacity *= 2;
+            source_file->content = content;
+            source_file->content_capacity = capacity;
+        }
 
-        if (character == WEOF) {
+        size_t read = fread(source_file->content + source_file->content_length, 1, capacity - source_file->content_length, handle);
+
+        if (read == 0) {
             break;
         }
 
-        cj_string_append(source_file->content, character, source_file->content_length, 512);
+        source_file->content_length += read;
 	}
 
+    int error = ferror(handle);
     fclose(handle);
 
+    if (error) {
+        cj_release_source_file(source_file);
+        return -1;
+    }
+
+    if (!cj_validate_utf8(source_file->content, source_file->content_length)) {
+        cj_release_source_file(source_file);
+        return -2;
+    }
+
+    source_file->validated = true;
 	return 0;
 }
+
+void cj_release_source_file(struct cj_source_file* source_file) {
+    struct cj_allocator* allocator = source_file->allocator;
+
+    if (source_file->path) {
+        cj_deallocate(allocator, SOURCE_FILE_MEMORY, source_file->content, source_file->content_capacity);
+        source_file->content = NULL;
+        source_file->content_length = 0;
+        source_file->content_capacity = 0;
+        source_file->validated = false;
+    }
+
+    cj_deallocate(allocator, SOURCE_FILE_MEMORY, source_file->line_starts, sizeof(size_t) * source_file->line_starts_capacity);
+    source_file->line_starts = NULL;
+    source_file->line_starts_length = 0;
+    source_file->line_starts_capacity = 0;
+}
+
+static bool cj_index_source_lines(struct cj_source_file* source_file) {
+    struct cj_allocator* allocator = source_file->allocator;
+    size_t capacity = 64;
+    size_t* line_starts = cj_allocate(allocator, SOURCE_FILE_MEMORY, sizeof(size_t) * capacity);
+    size_t line_starts_length = 1;
+
+    if (line_starts == NULL) {
+        return false;
+    }
+    line_starts[0] = 0;
+
+    const char* content = source_file->content;
+    const char* content_end = content + source_file->content_length;
+
+    while (content < content_end) {
+        const char* line_end = memchr(content, 0x0A, content_end - content);
+
+        if (line_end == NULL) {
+            break;
+        }
+
+        if (line_starts_length == capacity) {
+            size_t* resized = cj_reallocate(allocator, SOURCE_FILE_MEMORY, line_starts, sizeof(size_t) * capacity, sizeof(size_t) * capacity * 2);
+            if (resized == NULL) {
+                cj_deallocate(allocator, SOURCE_FILE_MEMORY, line_starts, sizeof(size_t) * capacity);
+                return false;
+            }
+            line_starts = resized;
+            capacity *= 2;
+        }
+
+        content = line_end + 1;
+        line_starts[line_starts_length++] = content - source_file->content;
+    }
+
+    source_file->line_starts = line_starts;
+    source_file->line_starts_length = line_starts_length;
+    source_file->line_starts_capacity = capacity;
+    return true;
+}
+
+static struct cj_source_position cj_scan_source_position(const struct cj_source_file* source_file, size_t position) {
+    struct cj_source_position source_position = {
+        .line = 0,
+        .column = position
+    };
+
+    const char* content = source_file->content;
+    const char* content_end = content + position;
+
+    while (content < content_end) {
+        const char* line_end = memchr(content, 0x0A, content_end - content);
+
+        if (line_end == NULL) {
+            break;
+        }
+
+        content = line_end + 1;
+        source_position.line++;
+        source_position.column = content_end - content;
+    }
+
+    return source_position;
+}
+
+struct cj_source_position cj_locate_source_position(struct cj_source_file* source_file, size_t position) {
+    if (source_file->line_starts == NULL && !cj_index_source_lines(source_file)) {
+        return cj_scan_source_position(source_file, position);
+    }
+
+    size_t low = 0;
+    size_t high = source_file->line_starts_length - 1;
+
+    while (low < high) {
+        size_t middle = low + (high - low + 1) / 2;
+
+        if (source_file->line_starts[middle] <= position) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    struct cj_source_position source_position = {
+        .line = low,
+        .column = position - source_file->line_starts[low]
+    };
+    return source_position;
+}
+
+void cj_discard_source_content(struct cj_source_file* source_file) {
+    if (source_file->path == NULL || (source_file->line_starts == NULL && !cj_index_source_lines(source_file))) {
+        return;
+    }
+
+    cj_deallocate(source_file->allocator, SOURCE_FILE_MEMORY, source_file->content, source_file->content_capacity);
+    source_file->content = NULL;
+    source_file->content_length = 0;
+    source_file->content_capacity = 0;
+    source_file->validated = false;
+}
@@ -22,15 +22,52 @@
 #ifndef CONJOINT_SRC_SOURCE_FILE_H_
 #define CONJOINT_SRC_SOURCE_FILE_H_
 
-#include <wchar.h>
+#include "allocator.h"
 
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Either `path` is set and the content is loaded with cj_read_source_file,
+ * or `content` and `content_length` are filled in directly by the caller.
+ * The content is UTF-8 and is not required to be NUL-terminated. It is
+ * validated by cj_read_source_file, which sets `validated`, or else by the
+ * parser before tokenizing it.
+ *
+ * The line index is built on first use by cj_locate_source_position. Both
+ * are allocated from `allocator`, which must be set. */
 struct cj_source_file {
 	char* path;
+	struct cj_allocator* allocator;
+
+	size_t content_length;
+	size_t content_capacity;
+	char* content;
+	bool validated;
+
+	size_t line_starts_length;
+	size_t line_starts_capacity;
+	size_t* line_starts;
+};
 
-	int content_length;
-	wchar_t* content;
+struct cj_source_position {
+	size_t line;
+	size_t column;
 };
 
+/* Returns -1 if the file can not be read, -2 if it is not valid UTF-8 and
+ * -3 if it does not fit in memory. */
 int cj_read_source_file(struct cj_source_file* source_file);
 
+/* Frees the line index, and the content if it was read from `path`. */
+void cj_release_source_file(struct cj_source_file* source_file);
+
+/* Frees content read from `path` once it is no longer needed, keeping the
+ * line index so that positions can still be located. Keeps the content if
+ * the index can not be allocated. */
+void cj_discard_source_content(struct cj_source_file* source_file);
+
+/* Zero-based line and byte column of a content offset. Falls back to a scan
+ * of the content when the line index can not be allocated. */
+struct cj_source_position cj_locate_source_position(struct cj_source_file* source_file, size_t position);
+
 #endif /* CONJOINT_SRC_SOURCE_FILE_H_ */
@@ -0,0 +1,43 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "standard_module.h"
+
+#include <stddef.h>
+#include <string.h>
+
+const struct cj_standard_module* cj_find_standard_module(const char* name) {
+    for (size_t i = 0; i < cj_standard_modules_length; i++) {
+        if (strcmp(cj_standard_modules[i].name, name) == 0) {
+            return &cj_standard_modules[i];
+        }
+    }
+    return NULL;
+}
+
+const struct cj_standard_export* cj_find_standard_export(const struct cj_standard_module* module, const char* name) {
+    for (size_t i = 0; i < module->exports_length; i++) {
+        if (strcmp(module->exports[i].name, name) == 0) {
+            return &module->exports[i];
+        }
+    }
+    return NULL;
+}
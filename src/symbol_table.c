@@ -0,0 +1,145 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "symbol_table.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+static uint32_t cj_hash_symbol(const char* string, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char) string[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void cj_release_symbol_slots(struct cj_symbol_table* symbol_table) {
+    cj_deallocate(symbol_table->allocator, SYMBOL_TABLE_MEMORY, symbol_table->symbols, sizeof(const char*) * symbol_table->symbols_capacity);
+    cj_deallocate(symbol_table->allocator, SYMBOL_TABLE_MEMORY, symbol_table->slots, sizeof(size_t) * (symbol_table->symbols_capacity / 2));
+}
+
+/* Symbols are inserted again in the order they were interned, so that
+ * taking them out newest first still leaves no gap in a probe sequence. */
+static bool cj_grow_symbol_table(struct cj_symbol_table* symbol_table) {
+    size_t capacity = symbol_table->symbols_capacity > 0 ? symbol_table->symbols_capacity * 2 : 64;
+    const char** symbols = cj_allocate(symbol_table->allocator, SYMBOL_TABLE_MEMORY, sizeof(const char*) * capacity);
+    size_t* slots = cj_allocate(symbol_table->allocator, SYMBOL_TABLE_MEMORY, sizeof(size_t) * (capacity / 2));
+
+    if (symbols == NULL || slots == NULL) {
+        cj_deallocate(symbol_table->allocator, SYMBOL_TABLE_MEMORY, symbols, sizeof(const char*) * capacity);
+        cj_deallocate(symbol_table->allocator, SYMBOL_TABLE_MEMORY, slots, sizeof(size_t) * (capacity / 2));
+        return false;
+    }
+    memset(symbols, 0, sizeof(const char*) * capacity);
+
+    for (size_t i = 0; i < symbol_table->symbols_length; i++) {
+        const char* symbol = symbol_table->symbols[symbol_table->slots[i]];
+        uint32_t slot = cj_hash_symbol(symbol, strlen(symbol)) & (capacity - 1);
+        while (symbols[slot] != NULL) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        symbols[slot] = symbol;
+        slots[i] = slot;
+    }
+
+    cj_release_symbol_slots(symbol_table);
+    symbol_table->symbols = symbols;
+    symbol_table->slots = slots;
+    symbol_table->symbols_capacity = capacity;
+    return true;
+}
+
+void cj_init_symbol_table(struct cj_symbol_table* symbol_table, struct cj_allocator* allocator) {
+    symbol_table->allocator = allocator;
+    cj_init_arena(&symbol_table->arena, allocator, SYMBOL_TABLE_MEMORY);
+    symbol_table->symbols_length = 0;
+    symbol_table->symbols_capacity = 0;
+    symbol_table->symbols = NULL;
+    symbol_table->slots = NULL;
+}
+
+const char* cj_intern_symbol(struct cj_symbol_table* symbol_table, const char* string, size_t length) {
+    uint32_t hash = cj_hash_symbol(string, length);
+
+    for (size_t i = 0; i < symbol_table->symbols_capacity; i++) {
+        const char* symbol = symbol_table->symbols[(hash + i) & (symbol_table->symbols_capacity - 1)];
+        if (symbol == NULL) {
+            break;
+        } else if (strncmp(symbol, string, length) == 0 && symbol[length] == '\0') {
+            return symbol;
+        }
+    }
+
+    if ((symbol_table->symbols_length + 1) * 2 > symbol_table->symbols_capacity && !cj_grow_symbol_table(symbol_table)) {
+        return NULL;
+    }
+
+    char* symbol = cj_arena_allocate(&symbol_table->arena, length + 1);
+    if (symbol == NULL) {
+        return NULL;
+    }
+
+    memcpy(symbol, string, length);
+    symbol[length] = '\0';
+
+    uint32_t mask = symbol_table->symbols_capacity - 1;
+    uint32_t slot = hash & mask;
+    while (symbol_table->symbols[slot] != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    symbol_table->symbols[slot] = symbol;
+    symbol_table->slots[symbol_table->symbols_length++] = slot;
+
+    return symbol;
+}
+
+struct cj_symbol_table_mark cj_mark_symbol_table(const struct cj_symbol_table* symbol_table) {
+    return (struct cj_symbol_table_mark) {
+        .arena = cj_mark_arena(&symbol_table->arena),
+        .symbols_length = symbol_table->symbols_length
+    };
+}
+
+void cj_rewind_symbol_table(struct cj_symbol_table* symbol_table, struct cj_symbol_table_mark mark) {
+    while (symbol_table->symbols_length > mark.symbols_length) {
+        symbol_table->symbols[symbol_table->slots[--symbol_table->symbols_length]] = NULL;
+    }
+    cj_rewind_arena(&symbol_table->arena, mark.arena);
+}
+
+void cj_clear_symbol_table(struct cj_symbol_table* symbol_table) {
+    cj_reset_arena(&symbol_table->arena);
+    if (symbol_table->symbols != NULL) {
+        memset(symbol_table->symbols, 0, sizeof(const char*) * symbol_table->symbols_capacity);
+    }
+    symbol_table->symbols_length = 0;
+}
+
+void cj_release_symbol_table(struct cj_symbol_table* symbol_table) {
+    cj_release_arena(&symbol_table->arena);
+    cj_release_symbol_slots(symbol_table);
+    symbol_table->symbols = NULL;
+    symbol_table->slots = NULL;
+    symbol_table->symbols_length = 0;
+    symbol_table->symbols_capacity = 0;
+}
@@ -0,0 +1,65 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_SYMBOL_TABLE_H_
+#define CONJOINT_SRC_SYMBOL_TABLE_H_
+
+#include "allocator.h"
+#include "arena.h"
+
+#include <stddef.h>
+
+/* Interns identifier names. Equal names share one pointer, so interned
+ * strings can be compared by address. */
+struct cj_symbol_table {
+    struct cj_allocator* allocator;
+    struct cj_arena arena;
+
+    size_t symbols_length;
+    size_t symbols_capacity;
+    const char** symbols;
+
+    /* Slots of the symbols in the order they were interned, so that a
+     * rewind can take out the newest ones. Half as long as `symbols`. */
+    size_t* slots;
+};
+
+struct cj_symbol_table_mark {
+    struct cj_arena_mark arena;
+    size_t symbols_length;
+};
+
+void cj_init_symbol_table(struct cj_symbol_table* symbol_table, struct cj_allocator* allocator);
+
+/* Returns NULL if the allocator fails. */
+const char* cj_intern_symbol(struct cj_symbol_table* symbol_table, const char* string, size_t length);
+
+struct cj_symbol_table_mark cj_mark_symbol_table(const struct cj_symbol_table* symbol_table);
+
+/* Forgets the names interned since the mark was taken. */
+void cj_rewind_symbol_table(struct cj_symbol_table* symbol_table, struct cj_symbol_table_mark mark);
+
+/* Forgets every interned name but keeps the storage for the next ones. */
+void cj_clear_symbol_table(struct cj_symbol_table* symbol_table);
+
+void cj_release_symbol_table(struct cj_symbol_table* symbol_table);
+
+#endif /* CONJOINT_SRC_SYMBOL_TABLE_H_ */
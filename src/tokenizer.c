@@ -20,12 +20,13 @@
  */
 
 #include "tokenizer.h"
-#include "util.h"
+#include "utf8.h"
 
 #include <assert.h>
-#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
-#include <wchar.h>
+#include <string.h>
 
 #define cj_check_whitespace(character) \
     (character == 0x20)
@@ -54,11 +55,18 @@
 #define cj_check_string_quote(character) \
     (character == 0x22)
 
-#define cj_token_value_init(token) \
-    cj_string_init(token->value, 8)
+#define cj_check_remaining(process, length) \
+    ((process->source_file->content_length - process->current_position) >= length)
 
-#define cj_token_value_append(token, character) \
-    cj_string_append(token->value, character, token->value_length, 8)
+#define cj_current_character(process) \
+    ((unsigned char) process->source_file->content[process->current_position])
+
+#define cj_scan_token(scanner, token, process) \
+    do { \
+        cj_enter_profiled(process, #scanner, process->current_position); \
+        scanner(token, process); \
+        cj_leave_profiled(process, process->current_position); \
+    } while (0)
 
 static char* token_type_strings[] = {
     "COMMENT",
@@ -70,30 +78,27 @@ static char* token_type_strings[] = {
     "NUMERIC_LITERAL",
     "CHARACTER_LITERAL",
     "STRING_LITERAL",
+    "ILLEGAL",
     "END_OF_FILE"
 };
 
-static struct cj_source_position* cj_fixate_current_position(const struct cj_tokenization_process* process) {
-	struct cj_source_position* position = malloc(sizeof(struct cj_source_position));
-    assert(position);
-	position->position = process->current_position;
-	position->line = process->current_line_number;
-	position->column = process->current_position - process->current_line_start_position;
-	return position;
+static void cj_start_token_value(struct cj_token* token, const struct cj_tokenization_process* process) {
+    token->value = process->source_file->content + process->current_position;
+    token->value_length = 0;
+}
+
+static void cj_finish_token_value(struct cj_token* token, const struct cj_tokenization_process* process) {
+    token->value_length = process->source_file->content + process->current_position - token->value;
 }
 
 static void cj_skip_whitespaces(struct cj_tokenization_process* process) {
-    wchar_t character;
+    unsigned char character;
 
     while (process->current_position < process->source_file->content_length) {
-        character = process->source_file->content[process->current_position];
+        character = cj_current_character(process);
 
-        if (cj_check_whitespace(character)) {
+        if (cj_check_whitespace(character) || cj_check_line_terminator(character)) {
             process->current_position++;
-        } else if (cj_check_line_terminator(character)) {
-            process->current_position++;
-            process->current_line_number++;
-            process->current_line_start_position = process->current_position;
         } else {
             break;
         }
@@ -101,50 +106,47 @@ static void cj_skip_whitespaces(struct cj_tokenization_process* process) {
 }
 
 static void cj_scan_comment(struct cj_token* token, struct cj_tokenization_process* process) {
-    wchar_t character = process->source_file->content[process->current_position];
-    assert(cj_check_comment_start(character));
+    assert(cj_check_comment_start(cj_current_character(process)));
     process->current_position++;
 
-    cj_token_value_init(token);
+    cj_start_token_value(token, process);
 
-    while (process->current_position < process->source_file->content_length) {
-        character = process->source_file->content[process->current_position];
+    const char* content = process->source_file->content + process->current_position;
+    const char* line_end = memchr(content, 0x0A, process->source_file->content_length - process->current_position);
 
-        if (cj_check_line_terminator(character)) {
-            break;
-        } else {
-            process->current_position++;
-            cj_token_value_append(token, character);
-        }
+    if (line_end != NULL) {
+        process->current_position += line_end - content;
+    } else {
+        process->current_position = process->source_file->content_length;
     }
 
+    cj_finish_token_value(token, process);
     token->type = COMMENT;
 }
 
 static void cj_scan_identifier(struct cj_token* token, struct cj_tokenization_process* process) {
-    wchar_t character = process->source_file->content[process->current_position];
-    assert(cj_check_identifier_start(character));
-    process->current_position++;
+    assert(cj_check_identifier_start(cj_current_character(process)));
 
-    cj_token_value_init(token);
-    cj_token_value_append(token, character);
+    cj_start_token_value(token, process);
+    process->current_position++;
 
     while (process->current_position < process->source_file->content_length) {
-        character = process->source_file->content[process->current_position];
+        unsigned char character = cj_current_character(process);
 
         if (cj_check_identifier_part(character)) {
             process->current_position++;
-            cj_token_value_append(token, character);
         } else {
             break;
         }
     }
 
-    if (wcscmp(token->value, L"let") == 0 || wcscmp(token->value, L"import") == 0 || wcscmp(token->value, L"from") == 0) {
+    cj_finish_token_value(token, process);
+
+    if (cj_check_token_value(token, "let") || cj_check_token_value(token, "import") || cj_check_token_value(token, "from")) {
         token->type = KEYWORD;
-    } else if (wcscmp(token->value, L"null") == 0) {
+    } else if (cj_check_token_value(token, "null")) {
         token->type = NULL_LITERAL;
-    } else if (wcscmp(token->value, L"true") == 0 || wcscmp(token->value, L"false") == 0) {
+    } else if (cj_check_token_value(token, "true") || cj_check_token_value(token, "false")) {
         token->type = BOOLEAN_LITERAL;
     } else {
         token->type = IDENTIFIER;
@@ -152,75 +154,86 @@ static void cj_scan_identifier(struct cj_token* token, struct cj_tokenization_pr
 }
 
 static void cj_scan_numeric_literal(struct cj_token* token, struct cj_tokenization_process* process) {
-    wchar_t character = process->source_file->content[process->current_position];
-    assert(cj_check_numeric(character));
-    process->current_position++;
+    assert(cj_check_numeric(cj_current_character(process)));
 
-    cj_token_value_init(token);
-    cj_token_value_append(token, character);
+    cj_start_token_value(token, process);
+    process->current_position++;
 
     while (process->current_position < process->source_file->content_length) {
-        character = process->source_file->content[process->current_position];
+        unsigned char character = cj_current_character(process);
 
         if (cj_check_numeric(character)) {
             process->current_position++;
-            cj_token_value_append(token, character);
         } else {
             break;
         }
     }
 
+    cj_finish_token_value(token, process);
     token->type = NUMERIC_LITERAL;
 }
 
 static void cj_scan_character_literal(struct cj_token* token, struct cj_tokenization_process* process) {
-    wchar_t character = process->source_file->content[process->current_position];
-    assert(cj_check_character_quote(character));
+    assert(cj_check_character_quote(cj_current_character(process)));
     process->current_position++;
 
-    character = process->source_file->content[process->current_position];
-    assert(!cj_check_character_quote(character));
-    cj_token_value_init(token);
-    cj_token_value_append(token, character);
-    process->current_position++;
+    cj_start_token_value(token, process);
+
+    uint32_t code_point;
+    int sequence_length = cj_decode_utf8(
+        process->source_file->content + process->current_position,
+        process->source_file->content_length - process->current_position,
+        &code_point
+    );
+
+    if (sequence_length < 0) {
+        process->current_position = process->source_file->content_length;
+        cj_finish_token_value(token, process);
+        token->type = ILLEGAL;
+        return;
+    }
+
+    process->current_position += sequence_length;
+    cj_finish_token_value(token, process);
+
+    if (cj_check_character_quote(code_point) || cj_check_line_terminator(code_point)
+            || !cj_check_remaining(process, 1) || !cj_check_character_quote(cj_current_character(process))) {
+        token->type = ILLEGAL;
+        return;
+    }
 
-    character = process->source_file->content[process->current_position];
-    assert(cj_check_character_quote(character));
     process->current_position++;
 
     token->type = CHARACTER_LITERAL;
 }
 
 static void cj_scan_string_literal(struct cj_token* token, struct cj_tokenization_process* process) {
-    wchar_t character = process->source_file->content[process->current_position];
-    assert(cj_check_string_quote(character));
+    assert(cj_check_string_quote(cj_current_character(process)));
     process->current_position++;
 
-    cj_token_value_init(token);
+    cj_start_token_value(token, process);
 
-    while (process->current_position < process->source_file->content_length) {
-        character = process->source_file->content[process->current_position];
+    const char* content = process->source_file->content + process->current_position;
+    const char* quote = memchr(content, 0x22, process->source_file->content_length - process->current_position);
 
-        if (cj_check_string_quote(character)) {
-            process->current_position++;
-            token->type = STRING_LITERAL;
-            return;
-        } else if (cj_check_line_terminator(character)) {
-            process->current_position++;
-            process->current_line_number++;
-            process->current_line_start_position = process->current_position;
-        } else {
-            process->current_position++;
-        }
-
-        cj_token_value_append(token, character);
+    if (quote == NULL) {
+        process->current_position = process->source_file->content_length;
+        cj_finish_token_value(token, process);
+        token->type = ILLEGAL;
+        return;
     }
 
-    assert(NULL);
+    process->current_position += quote - content;
+    cj_finish_token_value(token, process);
+    process->current_position++;
+    token->type = STRING_LITERAL;
 }
 
 static void cj_scan_punctuator(struct cj_token* token, struct cj_tokenization_process* process) {
-    wchar_t character = process->source_file->content[process->current_position];
+    unsigned char character = cj_current_character(process);
+
+    cj_start_token_value(token, process);
+    token->type = PUNCTUATOR;
 
     switch (character) {
         case 0x25: // %
@@ -241,98 +254,69 @@ static void cj_scan_punctuator(struct cj_token* token, struct cj_tokenization_pr
         case 0x7B: // {
         case 0x7D: // }
         case 0x7E: // ~
-            cj_token_value_init(token);
-            cj_token_value_append(token, character);
             process->current_position++;
-            token->type = PUNCTUATOR;
+            cj_finish_token_value(token, process);
             return;
     }
 
-    if ((process->source_file->content_length - process->current_position) >= 3) {
-        wchar_t* character3 = malloc(sizeof(wchar_t) * 4);
-        assert(character3);
-        wmemcpy(character3, process->source_file->content + process->current_position, 3);
-        character3[3] = '\0';
-        if (wcscmp(character3, L">>>") == 0) {
-            process->current_position += 3;
-            token->value = character3;
-            token->type = PUNCTUATOR;
-            return;
-        }
-        free(character3);
-    }
-
-    if ((process->source_file->content_length - process->current_position) >= 2) {
-        wchar_t* character2 = malloc(sizeof(wchar_t) * 3);
-        assert(character2);
-        wmemcpy(character2, process->source_file->content + process->current_position, 2);
-        character2[2] = '\0';
-        if (wcscmp(character2, L"!=") == 0 || (wcschr(L"<>&|=", character2[0]) != NULL && character2[0] == character2[1])) {
-            process->current_position += 2;
-            token->value = character2;
-            token->type = PUNCTUATOR;
-            return;
-        }
-        free(character2);
-    }
+    const char* content = token->value;
 
-    if (wcschr(L"<>=!&|", character) != NULL) {
-        cj_token_value_init(token);
-        cj_token_value_append(token, character);
+    if (cj_check_remaining(process, 3) && memcmp(content, ">>>", 3) == 0) {
+        process->current_position += 3;
+    } else if (cj_check_remaining(process, 2)
+            && ((content[0] == '!' && content[1] == '=') || (content[0] != '\0' && strchr("<>&|=", content[0]) != NULL && content[0] == content[1]))) {
+        process->current_position += 2;
+    } else if (character != '\0' && strchr("<>=!&|", character) != NULL) {
         process->current_position++;
-        token->type = PUNCTUATOR;
-        return;
+    } else {
+        uint32_t code_point;
+        int sequence_length = cj_decode_utf8(content, process->source_file->content_length - process->current_position, &code_point);
+        process->current_position += sequence_length > 0 ? sequence_length : 1;
+        token->type = ILLEGAL;
     }
 
-    assert(NULL);
+    cj_finish_token_value(token, process);
 }
 
-struct cj_token* cj_read_next_token(struct cj_tokenization_process* process) {
-	struct cj_token* token = malloc(sizeof(struct cj_token));
-    assert(token);
-    token->value_length = 0;
-	token->start = cj_fixate_current_position(process);
-
+void cj_read_next_token(struct cj_tokenization_process* process, struct cj_token* token) {
     cj_skip_whitespaces(process);
 
+	token->start = process->current_position;
+
     if (process->current_position >= process->source_file->content_length) {
         token->type = END_OF_FILE;
-        cj_token_value_init(token);
-        token->end = cj_fixate_current_position(process);
-        return token;
+        cj_start_token_value(token, process);
+        token->end = process->current_position;
+        return;
     }
 
-    wchar_t character = process->source_file->content[process->current_position];
+    unsigned char character = cj_current_character(process);
 
     if (cj_check_comment_start(character)) {
-        cj_scan_comment(token, process);
+        cj_scan_token(cj_scan_comment, token, process);
     } else if (cj_check_identifier_start(character)) {
-        cj_scan_identifier(token, process);
+        cj_scan_token(cj_scan_identifier, token, process);
     } else if (cj_check_numeric(character)) {
-        cj_scan_numeric_literal(token, process);
+        cj_scan_token(cj_scan_numeric_literal, token, process);
     } else if (cj_check_character_quote(character)) {
-        cj_scan_character_literal(token, process);
+        cj_scan_token(cj_scan_character_literal, token, process);
     } else if (cj_check_string_quote(character)) {
-        cj_scan_string_literal(token, process);
+        cj_scan_token(cj_scan_string_literal, token, process);
     } else {
-        cj_scan_punctuator(token, process);
+        cj_scan_token(cj_scan_punctuator, token, process);
     }
 
-    token->end = cj_fixate_current_position(process);
-
-	return token;
+    token->end = process->current_position;
 }
 
-void cj_release_token(struct cj_token* token) {
-    free(token->start);
-    free(token->end);
-    free(token->value);
-    free(token);
+bool cj_check_token_value(const struct cj_token* token, const char* value) {
+    size_t length = strlen(value);
+    return (size_t) token->value_length == length && memcmp(token->value, value, length) == 0;
 }
 
 void cj_print_token(const struct cj_token* token) {
 	printf("TYPE: %s\n", token_type_strings[token->type]);
-	wprintf(L"VALUE: `%ls`\n", token->value);
-	printf("START: p %d l %d c %d\n", token->start->position, token->start->line, token->start->column);
-	printf("END: p %d l %d c %d\n", token->end->position, token->end->line, token->end->column);
+	printf("VALUE: `%.*s`\n", (int) token->value_length, token->value);
+	printf("START: %zu\n", token->start);
+	printf("END: %zu\n", token->end);
 }
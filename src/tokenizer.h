@@ -22,9 +22,11 @@
 #ifndef CONJOINT_SRC_TOKENIZER_H_
 #define CONJOINT_SRC_TOKENIZER_H_
 
+#include "profiler.h"
 #include "source_file.h"
 
-#include <wchar.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 enum cj_token_type {
 	COMMENT,
@@ -36,35 +38,35 @@ enum cj_token_type {
 	NUMERIC_LITERAL,
 	CHARACTER_LITERAL,
 	STRING_LITERAL,
+	ILLEGAL,
 	END_OF_FILE
 };
 
-struct cj_source_position {
-	int position;
-	int line;
-	int column;
-};
-
+/* The value points into the source content and is not NUL-terminated. For
+ * comments and string or character literals the delimiters are excluded.
+ * `start` and `end` are content offsets, see cj_locate_source_position. */
 struct cj_token {
 	enum cj_token_type type;
 
-    int value_length;
-	wchar_t* value;
+    size_t value_length;
+	const char* value;
 
-	struct cj_source_position* start;
-	struct cj_source_position* end;
+	size_t start;
+	size_t end;
 };
 
 struct cj_tokenization_process {
 	struct cj_source_file* source_file;
-	int current_position;
-	int current_line_number;
-	int current_line_start_position;
+	size_t current_position;
+
+#ifdef CJ_PROFILE
+	struct cj_profiling_process* profiling_process;
+#endif
 };
 
-struct cj_token* cj_read_next_token(struct cj_tokenization_process* process);
+void cj_read_next_token(struct cj_tokenization_process* process, struct cj_token* token);
 
-void cj_release_token(struct cj_token* token);
+bool cj_check_token_value(const struct cj_token* token, const char* value);
 
 void cj_print_token(const struct cj_token* token);
 
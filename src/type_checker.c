@@ -0,0 +1,362 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "type_checker.h"
+#include "operator.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* type_names[] = {
+    "Null",
+    "Boolean",
+    "Number",
+    "Character",
+    "String"
+};
+
+const struct cj_checked_type cj_checked_types[CJ_TYPES_LENGTH] = {
+    {NULL_VALUE, false},
+    {NULL_VALUE, true},
+    {BOOLEAN_VALUE, false},
+    {BOOLEAN_VALUE, true},
+    {NUMBER_VALUE, false},
+    {NUMBER_VALUE, true},
+    {CHARACTER_VALUE, false},
+    {CHARACTER_VALUE, true},
+    {STRING_VALUE, false},
+    {STRING_VALUE, true}
+};
+
+/* Type of a literal by the type of its value children. */
+static const size_t literal_types[] = {
+    [NODE_TYPE] = CJ_NO_TYPE,
+    [STRING_TYPE] = 2 * STRING_VALUE,
+    [NUMBER_TYPE] = 2 * NUMBER_VALUE,
+    [CHARACTER_TYPE] = 2 * CHARACTER_VALUE,
+    [BOOLEAN_TYPE] = 2 * BOOLEAN_VALUE,
+    [NULL_TYPE] = 2 * NULL_VALUE
+};
+
+static size_t cj_resolve_type_name(struct cj_type_checking_process* process, const char* name) {
+    for (enum cj_value_type value_type = NULL_VALUE; value_type <= STRING_VALUE; value_type++) {
+        if (process->type_names[value_type] == name) {
+            return 2 * value_type;
+        }
+    }
+
+    for (enum cj_value_type value_type = NULL_VALUE; value_type <= STRING_VALUE; value_type++) {
+        if (strcmp(name, type_names[value_type]) == 0) {
+            process->type_names[value_type] = name;
+            return 2 * value_type;
+        }
+    }
+
+    return CJ_NO_TYPE;
+}
+
+/* Same rule as the backends: a value fits its own type, and the optional
+ * version of its type if it is not optional itself. Null fits any optional
+ * type. */
+static bool cj_check_assignable(size_t from, size_t to) {
+    struct cj_checked_type from_type = cj_checked_types[from];
+    struct cj_checked_type to_type = cj_checked_types[to];
+
+    if (from == to) {
+        return true;
+    } else if (!to_type.optional || from_type.optional) {
+        return false;
+    }
+    return from_type.value_type == to_type.value_type || from_type.value_type == NULL_VALUE;
+}
+
+static void cj_add_type_error(struct cj_type_checking_process* process, enum cj_type_error_kind kind, size_t position, const char* name, size_t type, size_t other_type) {
+    if (process->errors_length == process->errors_capacity) {
+        size_t capacity = process->errors_capacity > 0 ? process->errors_capacity * 2 : 64;
+        struct cj_type_error* errors = cj_reallocate(process->allocator, GENERAL_MEMORY, process->errors,
+            sizeof(struct cj_type_error) * process->errors_capacity,
+            sizeof(struct cj_type_error) * capacity);
+
+        if (errors == NULL) {
+            process->out_of_memory = true;
+            return;
+        }
+
+        process->errors = errors;
+        process->errors_capacity = capacity;
+    }
+
+    process->errors[process->errors_length++] = (struct cj_type_error) {
+        .kind = kind,
+        .position = position,
+        .name = name,
+        .types = {type, other_type}
+    };
+}
+
+static const char* cj_get_identifier_name(const struct cj_ast_tree_node* identifier) {
+    return cj_find_ast_tree_node_children(identifier, "value")->string;
+}
+
+/* A name declared twice is left to the backends. */
+static void cj_bind_checked_name(struct cj_type_checking_process* process, enum cj_binding_type type, const char* name, size_t index) {
+    if (cj_add_binding(&process->bindings, type, name, index) == BINDING_OUT_OF_MEMORY) {
+        process->out_of_memory = true;
+    }
+}
+
+static size_t cj_check_expression(struct cj_type_checking_process* process, const struct cj_ast_tree_node* expression);
+
+/* Returns the type of the operation. Operands of an unknown type are not
+ * reported, the backends report the names they come from. */
+static size_t cj_check_binary_operands(struct cj_type_checking_process* process, const struct cj_ast_tree_node* binary_expression, size_t left, size_t right) {
+    const char* symbol = cj_find_ast_tree_node_children(binary_expression, "operator")->string;
+    enum cj_operator operator = cj_find_binary_operator(symbol, strlen(symbol));
+    size_t type = 2 * BOOLEAN_VALUE;
+    bool valid;
+
+    switch (operator) {
+        case EQUAL_OPERATOR:
+        case NOT_EQUAL_OPERATOR:
+            return type;
+
+        case LOGICAL_OR_OPERATOR:
+        case LOGICAL_AND_OPERATOR:
+            valid = left == 2 * BOOLEAN_VALUE && right == 2 * BOOLEAN_VALUE;
+            break;
+
+        case LESS_OPERATOR:
+        case GREATER_OPERATOR:
+            valid = left == right && (left == 2 * NUMBER_VALUE || left == 2 * CHARACTER_VALUE);
+            break;
+
+        default:
+            type = 2 * NUMBER_VALUE;
+            valid = left == 2 * NUMBER_VALUE && right == 2 * NUMBER_VALUE;
+            break;
+    }
+
+    if (!valid && left != CJ_NO_TYPE && right != CJ_NO_TYPE) {
+        cj_add_type_error(process, OPERAND_TYPE_ERROR, binary_expression->start, cj_operators[operator].symbol, left, right);
+    }
+    return type;
+}
+
+/* Chains are walked in a loop, like in the backends. */
+static size_t cj_check_binary_expression(struct cj_type_checking_process* process, const struct cj_ast_tree_node* binary_expression) {
+    size_t spine_length = cj_push_ast_spine(&process->spine, binary_expression);
+    const struct cj_ast_tree_node* innermost = process->spine.nodes[process->spine.length - 1];
+    size_t type = cj_check_expression(process, cj_find_ast_tree_node_children(innermost, "left")->node);
+
+    for (size_t i = process->spine.length; i-- > spine_length;) {
+        const struct cj_ast_tree_node* node = process->spine.nodes[i];
+        size_t right = cj_check_expression(process, cj_find_ast_tree_node_children(node, "right")->node);
+        type = cj_check_binary_operands(process, node, type, right);
+    }
+
+    cj_pop_ast_spine(&process->spine, spine_length);
+    return type;
+}
+
+static size_t cj_check_unary_expression(struct cj_type_checking_process* process, const struct cj_ast_tree_node* unary_expression) {
+    const char* symbol = cj_find_ast_tree_node_children(unary_expression, "operator")->string;
+    enum cj_operator operator = cj_find_unary_operator(symbol, strlen(symbol));
+    size_t argument = cj_check_expression(process, cj_find_ast_tree_node_children(unary_expression, "argument")->node);
+    size_t type = operator == LOGICAL_NOT_OPERATOR ? 2 * BOOLEAN_VALUE : 2 * NUMBER_VALUE;
+
+    if (argument != type && argument != CJ_NO_TYPE) {
+        cj_add_type_error(process, OPERAND_TYPE_ERROR, unary_expression->start, cj_operators[operator].symbol, argument, CJ_NO_TYPE);
+    }
+    return type;
+}
+
+/* Natives all return null. The arguments are checked for their operators,
+ * whatever the callee is. */
+static size_t cj_check_call_expression(struct cj_type_checking_process* process, const struct cj_ast_tree_node* call_expression) {
+    const struct cj_ast_tree_node* callee = cj_find_ast_tree_node_children(call_expression, "callee")->node;
+    const struct cj_binding* binding = strcmp(callee->type, "Identifier") == 0 ? cj_find_binding(&process->bindings, cj_get_identifier_name(callee)) : NULL;
+
+    for (size_t i = 0; i < call_expression->childrens_length; i++) {
+        if (strcmp(call_expression->childrens[i]->name, "argument") == 0) {
+            cj_check_expression(process, call_expression->childrens[i]->node);
+        }
+    }
+
+    return binding != NULL && binding->type == NATIVE_BINDING ? 2 * NULL_VALUE : CJ_NO_TYPE;
+}
+
+/* Type of an expression, or CJ_NO_TYPE if it is not known before running
+ * the backends, which report the undeclared names and invalid callees that
+ * leave it unknown. */
+static size_t cj_check_expression(struct cj_type_checking_process* process, const struct cj_ast_tree_node* expression) {
+    if (strcmp(expression->type, "Literal") == 0) {
+        return literal_types[cj_find_ast_tree_node_children(expression, "value")->type];
+    } else if (strcmp(expression->type, "Identifier") == 0) {
+        const struct cj_binding* binding = cj_find_binding(&process->bindings, cj_get_identifier_name(expression));
+        return binding != NULL && binding->type == VARIABLE_BINDING ? binding->index : CJ_NO_TYPE;
+    } else if (strcmp(expression->type, "CallExpression") == 0) {
+        return cj_check_call_expression(process, expression);
+    } else if (strcmp(expression->type, "UnaryExpression") == 0) {
+        return cj_check_unary_expression(process, expression);
+    } else if (strcmp(expression->type, "BinaryExpression") == 0) {
+        return cj_check_binary_expression(process, expression);
+    }
+    return CJ_NO_TYPE;
+}
+
+/* Returns the declared type ID, after adding an error if it is unknown. */
+static size_t cj_check_variable_declaration(struct cj_type_checking_process* process, const struct cj_ast_tree_node* variable_declaration) {
+    const struct cj_ast_tree_node* type_identifier = NULL;
+    const struct cj_ast_tree_node* init = NULL;
+    bool optional = false;
+
+    /* One pass over the children instead of a lookup per relation. */
+    for (size_t i = 0; i < variable_declaration->childrens_length; i++) {
+        const struct cj_ast_tree_node_children* children = variable_declaration->childrens[i];
+
+        if (strcmp(children->name, "type") == 0) {
+            type_identifier = children->node;
+        } else if (strcmp(children->name, "optional") == 0) {
+            optional = children->boolean;
+        } else if (strcmp(children->name, "init") == 0) {
+            init = children->node;
+        }
+    }
+
+    const char* type_name = cj_get_identifier_name(type_identifier);
+    size_t type = cj_resolve_type_name(process, type_name);
+    size_t init_type = cj_check_expression(process, init);
+
+    if (type == CJ_NO_TYPE) {
+        cj_add_type_error(process, UNKNOWN_TYPE_ERROR, type_identifier->start, type_name, CJ_NO_TYPE, CJ_NO_TYPE);
+        return CJ_NO_TYPE;
+    }
+    type += optional;
+
+    if (init_type != CJ_NO_TYPE && !cj_check_assignable(init_type, type)) {
+        cj_add_type_error(process, INITIALIZER_TYPE_ERROR, init->start, type_name, type, init_type);
+    }
+    return type;
+}
+
+/* Binds the imported names the resolver knows, with the declared type of
+ * exported variables. Their declarations were checked when embedded. */
+static void cj_check_import_declaration(struct cj_type_checking_process* process, const struct cj_ast_tree_node* import_declaration) {
+    const struct cj_ast_tree_node* source = cj_find_ast_tree_node_children(import_declaration, "source")->node;
+    const char* module_name = cj_find_ast_tree_node_children(source, "value")->string;
+
+    for (size_t i = 0; i < import_declaration->childrens_length; i++) {
+        if (strcmp(import_declaration->childrens[i]->name, "specifier") != 0) {
+            continue;
+        }
+
+        const char* name = cj_get_identifier_name(import_declaration->childrens[i]->node);
+        const struct cj_ast_tree_node* declaration;
+
+        if (!process->import_resolver(module_name, name, &declaration)) {
+            continue;
+        } else if (declaration == NULL) {
+            cj_bind_checked_name(process, NATIVE_BINDING, name, CJ_NO_TYPE);
+        } else {
+            size_t type = cj_resolve_type_name(process, cj_get_identifier_name(cj_find_ast_tree_node_children(declaration, "type")->node));
+            if (type != CJ_NO_TYPE) {
+                type += cj_find_ast_tree_node_children(declaration, "optional")->boolean;
+            }
+            cj_bind_checked_name(process, VARIABLE_BINDING, name, type);
+        }
+    }
+}
+
+static void cj_format_checked_type(size_t type, char buffer[16]) {
+    snprintf(buffer, 16, "%s%s", type_names[cj_checked_types[type].value_type], cj_checked_types[type].optional ? "?" : "");
+}
+
+static void cj_report_type_errors(struct cj_type_checking_process* process) {
+    char first_type_name[16];
+    char second_type_name[16];
+
+    for (size_t i = 0; i < process->errors_length; i++) {
+        const struct cj_type_error* error = &process->errors[i];
+
+        if (error->kind == UNKNOWN_TYPE_ERROR) {
+            cj_report_diagnostic(&process->diagnostics, error->position, "unknown type `%s`", error->name);
+            continue;
+        }
+
+        cj_format_checked_type(error->types[0], first_type_name);
+        if (error->kind == INITIALIZER_TYPE_ERROR) {
+            cj_format_checked_type(error->types[1], second_type_name);
+            cj_report_diagnostic(&process->diagnostics, error->position, "`%s` can not be initialized with `%s`", first_type_name, second_type_name);
+        } else if (error->types[1] == CJ_NO_TYPE) {
+            cj_report_diagnostic(&process->diagnostics, error->position, "invalid operand for `%s`: `%s`", error->name, first_type_name);
+        } else {
+            cj_format_checked_type(error->types[1], second_type_name);
+            cj_report_diagnostic(&process->diagnostics, error->position, "invalid operands for `%s`: `%s` and `%s`", error->name, first_type_name, second_type_name);
+        }
+    }
+}
+
+void cj_init_type_checking_process(struct cj_type_checking_process* process, struct cj_allocator* allocator) {
+    memset(process, 0, sizeof(struct cj_type_checking_process));
+    process->allocator = allocator;
+    cj_init_diagnostic_list(&process->diagnostics, allocator);
+    cj_init_binding_table(&process->bindings, allocator);
+    cj_init_ast_spine(&process->spine);
+}
+
+void cj_release_type_checking_process(struct cj_type_checking_process* process) {
+    cj_release_diagnostic_list(&process->diagnostics);
+    cj_release_binding_table(&process->bindings);
+    cj_release_ast_spine(&process->spine);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->errors, sizeof(struct cj_type_error) * process->errors_capacity);
+    process->errors = NULL;
+    process->errors_length = 0;
+    process->errors_capacity = 0;
+}
+
+bool cj_check_types(struct cj_type_checking_process* process, const struct cj_ast_tree_node* root) {
+    cj_clear_diagnostic_list(&process->diagnostics);
+    memset(process->type_names, 0, sizeof(process->type_names));
+    cj_clear_binding_table(&process->bindings);
+    process->errors_length = 0;
+    process->out_of_memory = false;
+
+    for (size_t i = 0; i < root->childrens_length && !process->out_of_memory; i++) {
+        const struct cj_ast_tree_node* element = root->childrens[i]->node;
+
+        if (strcmp(element->type, "VariableDeclaration") == 0) {
+            size_t type = cj_check_variable_declaration(process, element);
+            const struct cj_ast_tree_node* id = cj_find_ast_tree_node_children(element, "id")->node;
+            cj_bind_checked_name(process, VARIABLE_BINDING, cj_get_identifier_name(id), type);
+        } else if (strcmp(element->type, "ImportDeclaration") == 0 && process->import_resolver != NULL) {
+            cj_check_import_declaration(process, element);
+        } else if (strcmp(element->type, "ExpressionStatement") == 0) {
+            cj_check_expression(process, cj_find_ast_tree_node_children(element, "expression")->node);
+        }
+    }
+
+    cj_report_type_errors(process);
+    if (process->out_of_memory) {
+        cj_report_diagnostic(&process->diagnostics, root->start, "out of memory");
+    }
+    return process->errors_length == 0 && !process->out_of_memory;
+}
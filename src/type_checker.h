@@ -0,0 +1,108 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_TYPE_CHECKER_H_
+#define CONJOINT_SRC_TYPE_CHECKER_H_
+
+#include "ast.h"
+#include "binding_table.h"
+#include "diagnostic.h"
+#include "value.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Types are numbered so that `2 * value_type + optional` is the ID. */
+#define CJ_TYPES_LENGTH ((STRING_VALUE + 1) * 2)
+
+#define CJ_NO_TYPE CJ_TYPES_LENGTH
+
+struct cj_checked_type {
+    enum cj_value_type value_type;
+    bool optional;
+};
+
+enum cj_type_error_kind {
+    UNKNOWN_TYPE_ERROR,
+    INITIALIZER_TYPE_ERROR,
+    OPERAND_TYPE_ERROR
+};
+
+/* `name` is the unknown type name or the operator symbol. `types` are the
+ * declared and initializer types, or the operand types, with CJ_NO_TYPE as
+ * the second one of a unary operator. */
+struct cj_type_error {
+    enum cj_type_error_kind kind;
+    size_t position;
+    const char* name;
+    size_t types[2];
+};
+
+/* Finds what `name` imported from `module_name` is. Returns false if it can
+ * not be imported, otherwise sets `declaration` to the VariableDeclaration
+ * of an exported variable, or to NULL for a native function. */
+typedef bool (*cj_import_resolver)(const char* module_name, const char* name, const struct cj_ast_tree_node** declaration);
+
+/* Checks the operands of every operator, and the initializers of variable
+ * declarations against their declared type, once for both backends. Errors are collected while walking the
+ * program, which visits every node at most once, and only formatted into
+ * the diagnostics at the end. Like the other processes it can be reused for
+ * many programs. */
+struct cj_type_checking_process {
+    struct cj_allocator* allocator;
+    struct cj_diagnostic_list diagnostics;
+
+    /* Resolves the specifiers of imports, if set. Names it does not resolve
+     * are left to the backends. */
+    cj_import_resolver import_resolver;
+
+    /* Declared names, with the type ID of variables as index. */
+    struct cj_binding_table bindings;
+
+    struct cj_ast_spine spine;
+
+    /* Interned names resolved to the base type IDs in the current program,
+     * so that a type name is compared by content only the first time it is
+     * seen. */
+    const char* type_names[STRING_VALUE + 1];
+
+    size_t errors_length;
+    size_t errors_capacity;
+    struct cj_type_error* errors;
+
+    /* Set when an error or a name could not be recorded, which fails the
+     * check with a single diagnostic. */
+    bool out_of_memory;
+};
+
+extern const struct cj_checked_type cj_checked_types[CJ_TYPES_LENGTH];
+
+void cj_init_type_checking_process(struct cj_type_checking_process* process, struct cj_allocator* allocator);
+
+void cj_release_type_checking_process(struct cj_type_checking_process* process);
+
+/* Returns false and fills the diagnostics if a declaration has an unknown
+ * type or an initializer it can not hold, if an operator is given operands
+ * it does not take, or if memory runs out. Names that are not declared before their use
+ * are left to the backends, which report them. */
+bool cj_check_types(struct cj_type_checking_process* process, const struct cj_ast_tree_node* root);
+
+#endif /* CONJOINT_SRC_TYPE_CHECKER_H_ */
@@ -0,0 +1,146 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "utf8.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static size_t cj_count_ascii_prefix(const char* string, size_t length) {
+    size_t position = 0;
+
+#if defined(__SSE2__)
+    while (position + 16 <= length) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*) (string + position));
+        if (_mm_movemask_epi8(chunk) != 0) {
+            break;
+        }
+        position += 16;
+    }
+#else
+    while (position + 8 <= length) {
+        uint64_t chunk;
+        memcpy(&chunk, string + position, 8);
+        if (chunk & 0x8080808080808080ull) {
+            break;
+        }
+        position += 8;
+    }
+#endif
+
+    while (position < length && (unsigned char) string[position] < 0x80) {
+        position++;
+    }
+
+    return position;
+}
+
+bool cj_validate_utf8(const char* string, size_t length) {
+    size_t position = 0;
+    uint32_t code_point;
+
+    while (1) {
+        position += cj_count_ascii_prefix(string + position, length - position);
+
+        if (position >= length) {
+            return true;
+        }
+
+        int sequence_length = cj_decode_utf8(string + position, length - position, &code_point);
+        if (sequence_length < 0) {
+            return false;
+        }
+        position += sequence_length;
+    }
+}
+
+int cj_decode_utf8(const char* string, size_t length, uint32_t* code_point) {
+    const unsigned char* bytes = (const unsigned char*) string;
+    uint32_t minimum;
+    int sequence_length;
+
+    if (length == 0) {
+        return -1;
+    }
+
+    if (bytes[0] < 0x80) {
+        *code_point = bytes[0];
+        return 1;
+    } else if ((bytes[0] & 0xE0) == 0xC0) {
+        *code_point = bytes[0] & 0x1F;
+        minimum = 0x80;
+        sequence_length = 2;
+    } else if ((bytes[0] & 0xF0) == 0xE0) {
+        *code_point = bytes[0] & 0x0F;
+        minimum = 0x800;
+        sequence_length = 3;
+    } else if ((bytes[0] & 0xF8) == 0xF0) {
+        *code_point = bytes[0] & 0x07;
+        minimum = 0x10000;
+        sequence_length = 4;
+    } else {
+        return -1;
+    }
+
+    if (length < (size_t) sequence_length) {
+        return -1;
+    }
+
+    for (int i = 1; i < sequence_length; i++) {
+        if ((bytes[i] & 0xC0) != 0x80) {
+            return -1;
+        }
+        *code_point = (*code_point << 6) | (bytes[i] & 0x3F);
+    }
+
+    if (*code_point < minimum || *code_point > 0x10FFFF || (*code_point >= 0xD800 && *code_point <= 0xDFFF)) {
+        return -1;
+    }
+
+    return sequence_length;
+}
+
+int cj_encode_utf8(uint32_t code_point, char* buffer) {
+    if (code_point < 0x80) {
+        buffer[0] = (char) code_point;
+        return 1;
+    } else if (code_point < 0x800) {
+        buffer[0] = (char) (0xC0 | (code_point >> 6));
+        buffer[1] = (char) (0x80 | (code_point & 0x3F));
+        return 2;
+    } else if (code_point < 0x10000) {
+        buffer[0] = (char) (0xE0 | (code_point >> 12));
+        buffer[1] = (char) (0x80 | ((code_point >> 6) & 0x3F));
+        buffer[2] = (char) (0x80 | (code_point & 0x3F));
+        return 3;
+    }
+
+    buffer[0] = (char) (0xF0 | (code_point >> 18));
+    buffer[1] = (char) (0x80 | ((code_point >> 12) & 0x3F));
+    buffer[2] = (char) (0x80 | ((code_point >> 6) & 0x3F));
+    buffer[3] = (char) (0x80 | (code_point & 0x3F));
+    return 4;
+}
@@ -0,0 +1,80 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "value.h"
+#include "utf8.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+size_t cj_format_value(struct cj_value value, char buffer[CJ_VALUE_BUFFER_SIZE], const char** data) {
+    *data = buffer;
+
+    switch (value.type) {
+        case NULL_VALUE:
+            memcpy(buffer, "null", 4);
+            return 4;
+
+        case BOOLEAN_VALUE:
+            if (value.boolean) {
+                memcpy(buffer, "true", 4);
+                return 4;
+            }
+            memcpy(buffer, "false", 5);
+            return 5;
+
+        case NUMBER_VALUE:
+            if (value.number == floor(value.number) && fabs(value.number) < 1e15) {
+                return snprintf(buffer, CJ_VALUE_BUFFER_SIZE, "%.0f", value.number);
+            }
+            return snprintf(buffer, CJ_VALUE_BUFFER_SIZE, "%.17g", value.number);
+
+        case CHARACTER_VALUE:
+            return cj_encode_utf8(value.character, buffer);
+
+        case STRING_VALUE:
+            *data = value.string->data;
+            return value.string->length;
+    }
+
+    return 0;
+}
+
+void cj_print_value(struct cj_value value, FILE* stream) {
+    char buffer[CJ_VALUE_BUFFER_SIZE];
+    const char* data;
+    size_t length = cj_format_value(value, buffer, &data);
+
+    switch (value.type) {
+        case CHARACTER_VALUE:
+            fprintf(stream, "'%.*s'", (int) length, data);
+            break;
+
+        case STRING_VALUE:
+            fprintf(stream, "\"%.*s\"", (int) length, data);
+            break;
+
+        default:
+            fprintf(stream, "%.*s", (int) length, data);
+            break;
+    }
+}
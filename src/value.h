@@ -0,0 +1,62 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_VALUE_H_
+#define CONJOINT_SRC_VALUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+enum cj_value_type {
+    NULL_VALUE,
+    BOOLEAN_VALUE,
+    NUMBER_VALUE,
+    CHARACTER_VALUE,
+    STRING_VALUE
+};
+
+struct cj_string {
+    size_t length;
+    const char* data;
+};
+
+struct cj_value {
+    enum cj_value_type type;
+
+    union {
+        bool boolean;
+        double number;
+        uint32_t character;
+        const struct cj_string* string;
+    };
+};
+
+#define CJ_VALUE_BUFFER_SIZE 32
+
+/* Formats the value the way printLine shows it. `data` is pointed either at
+ * `buffer` or, for strings, at the string itself. Returns the length. */
+size_t cj_format_value(struct cj_value value, char buffer[CJ_VALUE_BUFFER_SIZE], const char** data);
+
+void cj_print_value(struct cj_value value, FILE* stream);
+
+#endif /* CONJOINT_SRC_VALUE_H_ */
@@ -0,0 +1,256 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "vm.h"
+#include "operator.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* With GCC and Clang every handler jumps straight to the next one through a
+ * table of label addresses, otherwise the loop falls back to a switch. */
+#if defined(__GNUC__) && !defined(CJ_NO_COMPUTED_GOTO)
+#define CJ_COMPUTED_GOTO
+#endif
+
+#ifdef CJ_COMPUTED_GOTO
+#define cj_dispatch() \
+    goto *dispatch_table[cj_instruction_opcode(*ip)]
+#define cj_opcode_handler(opcode) \
+    handle_##opcode
+#else
+#define cj_dispatch() \
+    break
+#define cj_opcode_handler(opcode) \
+    case opcode
+#endif
+
+void cj_init_virtual_machine(struct cj_virtual_machine* machine, struct cj_allocator* allocator, FILE* output_stream) {
+    machine->allocator = allocator;
+    machine->registers_capacity = 0;
+    machine->registers = NULL;
+    machine->error[0] = '\0';
+    machine->output_stream = output_stream;
+    machine->output_length = 0;
+}
+
+void cj_release_virtual_machine(struct cj_virtual_machine* machine) {
+    cj_flush_output(machine);
+    cj_deallocate(machine->allocator, GENERAL_MEMORY, machine->registers, sizeof(struct cj_value) * machine->registers_capacity);
+    machine->registers = NULL;
+    machine->registers_capacity = 0;
+}
+
+void cj_write_output(struct cj_virtual_machine* machine, const char* data, size_t length) {
+    if (machine->output_length + length > CJ_OUTPUT_BUFFER_SIZE) {
+        cj_flush_output(machine);
+
+        if (length > CJ_OUTPUT_BUFFER_SIZE) {
+            fwrite(data, 1, length, machine->output_stream);
+            return;
+        }
+    }
+
+    memcpy(machine->output + machine->output_length, data, length);
+    machine->output_length += length;
+}
+
+void cj_flush_output(struct cj_virtual_machine* machine) {
+    if (machine->output_length > 0) {
+        fwrite(machine->output, 1, machine->output_length, machine->output_stream);
+        machine->output_length = 0;
+    }
+    fflush(machine->output_stream);
+}
+
+static const enum cj_operator opcode_operators[] = {
+    [OP_BITWISE_OR] = BITWISE_OR_OPERATOR,
+    [OP_BITWISE_XOR] = BITWISE_XOR_OPERATOR,
+    [OP_BITWISE_AND] = BITWISE_AND_OPERATOR,
+    [OP_EQUAL] = EQUAL_OPERATOR,
+    [OP_NOT_EQUAL] = NOT_EQUAL_OPERATOR,
+    [OP_LESS] = LESS_OPERATOR,
+    [OP_GREATER] = GREATER_OPERATOR,
+    [OP_LEFT_SHIFT] = LEFT_SHIFT_OPERATOR,
+    [OP_RIGHT_SHIFT] = RIGHT_SHIFT_OPERATOR,
+    [OP_UNSIGNED_RIGHT_SHIFT] = UNSIGNED_RIGHT_SHIFT_OPERATOR,
+    [OP_ADD] = ADD_OPERATOR,
+    [OP_SUBTRACT] = SUBTRACT_OPERATOR,
+    [OP_MULTIPLY] = MULTIPLY_OPERATOR,
+    [OP_DIVIDE] = DIVIDE_OPERATOR,
+    [OP_REMAINDER] = REMAINDER_OPERATOR,
+    [OP_NEGATE] = NEGATE_OPERATOR,
+    [OP_BITWISE_NOT] = BITWISE_NOT_OPERATOR,
+    [OP_NOT] = LOGICAL_NOT_OPERATOR
+};
+
+/* Handler for arithmetic on two numbers; other operand types go through the
+ * generic operator implementation. */
+#define cj_number_operation(operation, result_type, result_field) \
+    left = &registers[ip[1]]; \
+    right = &registers[ip[2]]; \
+    if (left->type == NUMBER_VALUE && right->type == NUMBER_VALUE) { \
+        destination = &registers[cj_instruction_destination(ip[0])]; \
+        destination->result_field = left->number operation right->number; \
+        destination->type = result_type; \
+        ip += 3; \
+        cj_dispatch(); \
+    } \
+    goto binary_operation
+
+bool cj_execute(struct cj_virtual_machine* machine, const struct cj_bytecode_program* program) {
+    if (machine->registers_capacity < program->registers_length) {
+        cj_deallocate(machine->allocator, GENERAL_MEMORY, machine->registers, sizeof(struct cj_value) * machine->registers_capacity);
+        machine->registers = cj_allocate(machine->allocator, GENERAL_MEMORY, sizeof(struct cj_value) * program->registers_length);
+        machine->registers_capacity = machine->registers != NULL ? program->registers_length : 0;
+
+        if (machine->registers == NULL) {
+            snprintf(machine->error, sizeof(machine->error), "out of memory");
+            return false;
+        }
+    }
+
+    struct cj_value* registers = machine->registers;
+    const struct cj_value* constants = program->constants;
+    const uint32_t* ip = program->code;
+    const struct cj_value* left;
+    const struct cj_value* right;
+    struct cj_value* destination;
+
+#ifdef CJ_COMPUTED_GOTO
+    static void* dispatch_table[] = {
+        &&handle_OP_LOAD_CONSTANT,
+        &&handle_OP_MOVE,
+        &&handle_OP_CALL_NATIVE,
+        &&handle_OP_BITWISE_OR,
+        &&handle_OP_BITWISE_XOR,
+        &&handle_OP_BITWISE_AND,
+        &&handle_OP_EQUAL,
+        &&handle_OP_NOT_EQUAL,
+        &&handle_OP_LESS,
+        &&handle_OP_GREATER,
+        &&handle_OP_LEFT_SHIFT,
+        &&handle_OP_RIGHT_SHIFT,
+        &&handle_OP_UNSIGNED_RIGHT_SHIFT,
+        &&handle_OP_ADD,
+        &&handle_OP_SUBTRACT,
+        &&handle_OP_MULTIPLY,
+        &&handle_OP_DIVIDE,
+        &&handle_OP_REMAINDER,
+        &&handle_OP_NEGATE,
+        &&handle_OP_BITWISE_NOT,
+        &&handle_OP_NOT,
+        &&handle_OP_JUMP_IF_FALSE,
+        &&handle_OP_JUMP_IF_TRUE,
+        &&handle_OP_HALT
+    };
+
+    cj_dispatch();
+#else
+    while (1) switch (cj_instruction_opcode(*ip))
+#endif
+    {
+        cj_opcode_handler(OP_LOAD_CONSTANT):
+            registers[cj_instruction_destination(ip[0])] = constants[ip[1]];
+            ip += 2;
+            cj_dispatch();
+
+        cj_opcode_handler(OP_MOVE):
+            registers[cj_instruction_destination(ip[0])] = registers[ip[1]];
+            ip += 2;
+            cj_dispatch();
+
+        cj_opcode_handler(OP_CALL_NATIVE):
+            registers[cj_instruction_destination(ip[0])] = program->natives[ip[1]]->function(machine, registers + ip[2], ip[3]);
+            ip += 4;
+            cj_dispatch();
+
+        cj_opcode_handler(OP_ADD):
+            cj_number_operation(+, NUMBER_VALUE, number);
+
+        cj_opcode_handler(OP_SUBTRACT):
+            cj_number_operation(-, NUMBER_VALUE, number);
+
+        cj_opcode_handler(OP_MULTIPLY):
+            cj_number_operation(*, NUMBER_VALUE, number);
+
+        cj_opcode_handler(OP_DIVIDE):
+            cj_number_operation(/, NUMBER_VALUE, number);
+
+        cj_opcode_handler(OP_LESS):
+            cj_number_operation(<, BOOLEAN_VALUE, boolean);
+
+        cj_opcode_handler(OP_GREATER):
+            cj_number_operation(>, BOOLEAN_VALUE, boolean);
+
+        cj_opcode_handler(OP_BITWISE_OR):
+        cj_opcode_handler(OP_BITWISE_XOR):
+        cj_opcode_handler(OP_BITWISE_AND):
+        cj_opcode_handler(OP_EQUAL):
+        cj_opcode_handler(OP_NOT_EQUAL):
+        cj_opcode_handler(OP_LEFT_SHIFT):
+        cj_opcode_handler(OP_RIGHT_SHIFT):
+        cj_opcode_handler(OP_UNSIGNED_RIGHT_SHIFT):
+        cj_opcode_handler(OP_REMAINDER):
+            left = &registers[ip[1]];
+            right = &registers[ip[2]];
+        binary_operation:
+            if (!cj_apply_binary_operator(opcode_operators[cj_instruction_opcode(ip[0])], *left, *right, &registers[cj_instruction_destination(ip[0])])) {
+                snprintf(machine->error, sizeof(machine->error), "invalid operands for `%s`", cj_operators[opcode_operators[cj_instruction_opcode(ip[0])]].symbol);
+                return false;
+            }
+            ip += 3;
+            cj_dispatch();
+
+        cj_opcode_handler(OP_NEGATE):
+        cj_opcode_handler(OP_BITWISE_NOT):
+        cj_opcode_handler(OP_NOT):
+            if (!cj_apply_unary_operator(opcode_operators[cj_instruction_opcode(ip[0])], registers[ip[1]], &registers[cj_instruction_destination(ip[0])])) {
+                snprintf(machine->error, sizeof(machine->error), "invalid operand for `%s`", cj_operators[opcode_operators[cj_instruction_opcode(ip[0])]].symbol);
+                return false;
+            }
+            ip += 2;
+            cj_dispatch();
+
+        cj_opcode_handler(OP_JUMP_IF_FALSE):
+        cj_opcode_handler(OP_JUMP_IF_TRUE):
+            left = &registers[cj_instruction_destination(ip[0])];
+            if (left->type != BOOLEAN_VALUE) {
+                snprintf(machine->error, sizeof(machine->error), "expected a boolean operand");
+                return false;
+            }
+            if (left->boolean == (cj_instruction_opcode(ip[0]) == OP_JUMP_IF_TRUE)) {
+                ip = program->code + ip[1];
+            } else {
+                ip += 2;
+            }
+            cj_dispatch();
+
+        cj_opcode_handler(OP_HALT):
+            return true;
+    }
+
+    return true;
+}
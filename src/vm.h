@@ -0,0 +1,60 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_VM_H_
+#define CONJOINT_SRC_VM_H_
+
+#include "bytecode.h"
+#include "value.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define CJ_OUTPUT_BUFFER_SIZE 8192
+
+/* Executes bytecode programs. The register file and the output buffer are
+ * kept between runs. */
+struct cj_virtual_machine {
+    struct cj_allocator* allocator;
+    size_t registers_capacity;
+    struct cj_value* registers;
+
+    char error[96];
+
+    FILE* output_stream;
+    size_t output_length;
+    char output[CJ_OUTPUT_BUFFER_SIZE];
+};
+
+void cj_init_virtual_machine(struct cj_virtual_machine* machine, struct cj_allocator* allocator, FILE* output_stream);
+
+void cj_release_virtual_machine(struct cj_virtual_machine* machine);
+
+/* Returns false and describes the failure in `error` on a runtime error,
+ * or if the registers can not be allocated. */
+bool cj_execute(struct cj_virtual_machine* machine, const struct cj_bytecode_program* program);
+
+void cj_write_output(struct cj_virtual_machine* machine, const char* data, size_t length);
+
+void cj_flush_output(struct cj_virtual_machine* machine);
+
+#endif /* CONJOINT_SRC_VM_H_ */
@@ -0,0 +1,769 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifdef __linux__
+
+#include "watch.h"
+
+#include <assert.h>
+#include <dirent.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CJ_WATCH_EVENTS (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+
+/* A file is created empty and written afterwards, so it is only checked
+ * once it is closed. IN_CREATE only adds the watches of new directories. */
+#define CJ_WATCH_FILE_EVENTS (IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+
+#define CJ_MINIMUM_COMPACTED_SYMBOLS_LENGTH 256
+
+static bool cj_grow_array(struct cj_watching_process* process, void** items, size_t* capacity, size_t length, size_t item_size) {
+    if (length < *capacity) {
+        return true;
+    }
+
+    size_t grown_capacity = *capacity > 0 ? *capacity * 2 : 8;
+    void* grown = cj_reallocate(process->allocator, GENERAL_MEMORY, *items, item_size * *capacity, item_size * grown_capacity);
+    if (grown == NULL) {
+        process->out_of_memory = true;
+        return false;
+    }
+
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+/* Drops `.` and `..` components and repeated slashes in place, so that every
+ * spelling of a path is interned once. */
+static size_t cj_normalize_path(char* path, size_t length) {
+    size_t root = path[0] == '/' ? 1 : 0;
+    size_t result = root;
+
+    for (size_t start = root; start < length;) {
+        size_t end = start;
+        while (end < length && path[end] != '/') {
+            end++;
+        }
+
+        size_t component_length = end - start;
+        size_t last = result;
+        while (last > root && path[last - 1] != '/') {
+            last--;
+        }
+
+        if (component_length == 0 || (component_length == 1 && path[start] == '.')) {
+            /* Nothing to keep. */
+        } else if (component_length == 2 && path[start] == '.' && path[start + 1] == '.'
+                && result > root && !(result - last == 2 && path[last] == '.' && path[last + 1] == '.')) {
+            result = last > root ? last - 1 : root;
+        } else {
+            if (result > root) {
+                path[result++] = '/';
+            }
+            memmove(path + result, path + start, component_length);
+            result += component_length;
+        }
+
+        start = end + 1;
+    }
+
+    if (result == 0) {
+        path[result++] = '.';
+    }
+    return result;
+}
+
+/* Interns `directory/name` followed by `suffix`, or NULL if it is too
+ * long or memory runs out. */
+static const char* cj_intern_path(struct cj_watching_process* process, const char* directory, size_t directory_length, const char* name, const char* suffix) {
+    char path[PATH_MAX];
+    int length = snprintf(path, sizeof(path), "%.*s%s%s%s", (int) directory_length, directory, directory_length > 0 ? "/" : "", name, suffix);
+
+    if (length < 0 || (size_t) length >= sizeof(path)) {
+        return NULL;
+    }
+    const char* interned = cj_intern_symbol(&process->paths, path, cj_normalize_path(path, length));
+    if (interned == NULL) {
+        process->out_of_memory = true;
+    }
+    return interned;
+}
+
+static const char* cj_intern_name(struct cj_watching_process* process, const struct cj_ast_tree_node* identifier) {
+    const char* value = cj_find_ast_tree_node_children(identifier, "value")->string;
+    const char* name = cj_intern_symbol(&process->names, value, strlen(value));
+    if (name == NULL) {
+        process->out_of_memory = true;
+    }
+    return name;
+}
+
+static size_t cj_hash_path(const char* path) {
+    return (size_t) (((uintptr_t) path >> 3) * 2654435761u);
+}
+
+static size_t* cj_find_file_slot(size_t* slots, size_t capacity, const struct cj_watched_file* files, const char* path) {
+    size_t slot = cj_hash_path(path) & (capacity - 1);
+    while (slots[slot] != 0 && files[slots[slot] - 1].path != path) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return &slots[slot];
+}
+
+static struct cj_watched_file* cj_find_watched_file(struct cj_watching_process* process, const char* path) {
+    if (process->files_slots_capacity == 0) {
+        return NULL;
+    }
+
+    size_t slot = *cj_find_file_slot(process->files_slots, process->files_slots_capacity, process->files, path);
+    return slot != 0 ? &process->files[slot - 1] : NULL;
+}
+
+static void cj_fill_file_slots(struct cj_watching_process* process) {
+    memset(process->files_slots, 0, sizeof(size_t) * process->files_slots_capacity);
+
+    for (size_t i = 0; i < process->files_length; i++) {
+        *cj_find_file_slot(process->files_slots, process->files_slots_capacity, process->files, process->files[i].path) = i + 1;
+    }
+}
+
+static bool cj_grow_file_slots(struct cj_watching_process* process) {
+    size_t capacity = process->files_slots_capacity > 0 ? process->files_slots_capacity * 2 : 64;
+    size_t* slots = cj_allocate(process->allocator, GENERAL_MEMORY, sizeof(size_t) * capacity);
+    if (slots == NULL) {
+        process->out_of_memory = true;
+        return false;
+    }
+
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->files_slots, sizeof(size_t) * process->files_slots_capacity);
+    process->files_slots = slots;
+    process->files_slots_capacity = capacity;
+    cj_fill_file_slots(process);
+    return true;
+}
+
+/* Returns NULL if memory runs out. */
+static struct cj_watched_file* cj_add_watched_file(struct cj_watching_process* process, const char* path) {
+    struct cj_watched_file* file = cj_find_watched_file(process, path);
+    if (file != NULL) {
+        return file;
+    }
+
+    if (((process->files_length + 1) * 2 > process->files_slots_capacity && !cj_grow_file_slots(process))
+            || !cj_grow_array(process, (void**) &process->files, &process->files_capacity, process->files_length, sizeof(struct cj_watched_file))) {
+        return NULL;
+    }
+
+    file = &process->files[process->files_length++];
+    memset(file, 0, sizeof(struct cj_watched_file));
+    file->path = path;
+    file->source_file.allocator = process->allocator;
+    cj_init_diagnostic_list(&file->diagnostics, process->allocator);
+
+    *cj_find_file_slot(process->files_slots, process->files_slots_capacity, process->files, path) = process->files_length;
+    return file;
+}
+
+static void cj_mark_file_changed(struct cj_watching_process* process, struct cj_watched_file* file) {
+    if (file != NULL && !file->changed
+            && cj_grow_array(process, (void**) &process->changes, &process->changes_capacity, process->changes_length, sizeof(size_t))) {
+        file->changed = true;
+        process->changes[process->changes_length++] = file - process->files;
+    }
+}
+
+static bool cj_check_source_path(const char* name) {
+    size_t length = strlen(name);
+    return length > 3 && strcmp(name + length - 3, ".cj") == 0;
+}
+
+/* Watches the directory and everything below it, and marks the sources
+ * found there as changed. */
+static void cj_watch_directory(struct cj_watching_process* process, const char* path) {
+    int descriptor = inotify_add_watch(process->inotify_descriptor, path, CJ_WATCH_EVENTS | IN_ONLYDIR);
+    if (descriptor < 0) {
+        fprintf(stderr, "Unable to watch directory \"%s\"\n", path);
+        return;
+    }
+
+    while ((size_t) descriptor >= process->directories_capacity) {
+        size_t capacity = process->directories_capacity > 0 ? process->directories_capacity * 2 : 64;
+        const char** directories = cj_reallocate(process->allocator, GENERAL_MEMORY, process->directories,
+                sizeof(const char*) * process->directories_capacity, sizeof(const char*) * capacity);
+        if (directories == NULL) {
+            inotify_rm_watch(process->inotify_descriptor, descriptor);
+            process->out_of_memory = true;
+            return;
+        }
+
+        process->directories = directories;
+        memset(process->directories + process->directories_capacity, 0, sizeof(const char*) * (capacity - process->directories_capacity));
+        process->directories_capacity = capacity;
+    }
+    process->directories[descriptor] = path;
+
+    DIR* directory = opendir(path);
+    if (directory == NULL) {
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+
+        const char* entry_path = cj_intern_path(process, path, strlen(path), entry->d_name, "");
+        struct stat entry_stat;
+
+        if (entry_path == NULL || stat(entry_path, &entry_stat) != 0) {
+            continue;
+        }
+
+        if (S_ISDIR(entry_stat.st_mode)) {
+            cj_watch_directory(process, entry_path);
+        } else if (S_ISREG(entry_stat.st_mode) && cj_check_source_path(entry_path)) {
+            cj_mark_file_changed(process, cj_add_watched_file(process, entry_path));
+        }
+    }
+
+    closedir(directory);
+}
+
+struct cj_file_parsing {
+    struct cj_watching_process* process;
+    struct cj_watched_file* file;
+};
+
+static size_t cj_get_directory_length(const char* path) {
+    const char* separator = strrchr(path, '/');
+    return separator != NULL ? (size_t) (separator - path) : 0;
+}
+
+static void cj_record_import_declaration(struct cj_watching_process* process, struct cj_watched_file* file, const struct cj_ast_tree_node* import_declaration) {
+    const struct cj_ast_tree_node* source = cj_find_ast_tree_node_children(import_declaration, "source")->node;
+    const char* source_value = cj_find_ast_tree_node_children(source, "value")->string;
+
+    const char* import_source = cj_intern_symbol(&process->paths, source_value, strlen(source_value));
+    if (import_source == NULL) {
+        process->out_of_memory = true;
+        return;
+    }
+
+    if (!cj_grow_array(process, (void**) &file->imports, &file->imports_capacity, file->imports_length, sizeof(struct cj_watched_import))) {
+        return;
+    }
+
+    struct cj_watched_import* import = &file->imports[file->imports_length++];
+    import->source = import_source;
+    import->module = cj_find_native_module(source_value);
+    import->standard_module = import->module == NULL ? cj_find_standard_module(source_value) : NULL;
+    import->path = import->module == NULL && import->standard_module == NULL ? cj_intern_path(process, file->path, cj_get_directory_length(file->path), source_value, ".cj") : NULL;
+    import->position = source->start;
+    import->specifiers_start = file->specifiers_length;
+    import->specifiers_length = 0;
+
+    for (size_t i = 0; i < import_declaration->childrens_length; i++) {
+        if (strcmp(import_declaration->childrens[i]->name, "specifier") != 0) {
+            continue;
+        }
+
+        const struct cj_ast_tree_node* specifier = import_declaration->childrens[i]->node;
+        const char* name = cj_intern_name(process, specifier);
+        if (name == NULL
+                || !cj_grow_array(process, (void**) &file->specifiers, &file->specifiers_capacity, file->specifiers_length, sizeof(struct cj_watched_specifier))) {
+            return;
+        }
+
+        file->specifiers[file->specifiers_length].name = name;
+        file->specifiers[file->specifiers_length].position = specifier->start;
+        file->specifiers_length++;
+        import->specifiers_length++;
+    }
+}
+
+static void cj_record_program_element(struct cj_ast_tree_node* element, void* data) {
+    struct cj_file_parsing* parsing = data;
+    struct cj_watched_file* file = parsing->file;
+
+    if (strcmp(element->type, "ImportDeclaration") == 0) {
+        cj_record_import_declaration(parsing->process, file, element);
+    } else if (strcmp(element->type, "VariableDeclaration") == 0) {
+        const struct cj_ast_tree_node* id = cj_find_ast_tree_node_children(element, "id")->node;
+        const char* name = cj_intern_name(parsing->process, id);
+        if (name != NULL
+                && cj_grow_array(parsing->process, (void**) &file->exports, &file->exports_capacity, file->exports_length, sizeof(const char*))) {
+            file->exports[file->exports_length++] = name;
+        }
+    }
+}
+
+static void cj_remove_importer(struct cj_watched_file* dependency, size_t importer) {
+    for (size_t i = 0; i < dependency->importers_length; i++) {
+        if (dependency->importers[i] == importer) {
+            dependency->importers[i] = dependency->importers[--dependency->importers_length];
+            return;
+        }
+    }
+}
+
+/* Reads and parses a changed file, and updates the importers of the files
+ * it imports. The names it keeps are interned again into `names`, the ones
+ * of the parsing process only last until the next parse. */
+static void cj_parse_watched_file(struct cj_watching_process* process, size_t index) {
+    struct cj_watched_file* file = &process->files[index];
+
+    for (size_t i = 0; i < file->imports_length; i++) {
+        struct cj_watched_file* dependency = file->imports[i].path != NULL ? cj_find_watched_file(process, file->imports[i].path) : NULL;
+        if (dependency != NULL) {
+            cj_remove_importer(dependency, index);
+        }
+    }
+
+    cj_release_source_file(&file->source_file);
+    file->source_file.path = (char*) file->path;
+    cj_clear_diagnostic_list(&file->diagnostics);
+    file->exports_length = 0;
+    file->imports_length = 0;
+    file->specifiers_length = 0;
+
+    int read_status = cj_read_source_file(&file->source_file);
+    file->present = read_status != -1;
+
+    if (read_status == -2) {
+        cj_report_diagnostic(&file->diagnostics, 0, "file is not valid UTF-8");
+    } else if (read_status == -3) {
+        cj_report_diagnostic(&file->diagnostics, 0, "file does not fit in memory");
+    } else if (read_status == 0) {
+        struct cj_file_parsing parsing = {
+            .process = process,
+            .file = file
+        };
+        cj_parse_program_elements(&process->parsing_process, &file->source_file, cj_record_program_element, &parsing);
+
+        for (size_t i = 0; i < process->parsing_process.diagnostics.length; i++) {
+            const struct cj_diagnostic* diagnostic = &process->parsing_process.diagnostics.diagnostics[i];
+            cj_report_diagnostic(&file->diagnostics, diagnostic->position, "%s", diagnostic->message);
+        }
+
+        cj_discard_source_content(&file->source_file);
+    }
+
+    file->parse_diagnostics_length = file->diagnostics.length;
+
+    /* Adding a file may move the others. */
+    for (size_t i = 0; i < process->files[index].imports_length; i++) {
+        const char* path = process->files[index].imports[i].path;
+        if (path != NULL) {
+            struct cj_watched_file* dependency = cj_add_watched_file(process, path);
+            if (dependency != NULL
+                    && cj_grow_array(process, (void**) &dependency->importers, &dependency->importers_capacity, dependency->importers_length, sizeof(size_t))) {
+                dependency->importers[dependency->importers_length++] = index;
+            }
+        }
+    }
+}
+
+static bool cj_check_file_exports(const struct cj_watched_file* file, const char* name) {
+    for (size_t i = 0; i < file->exports_length; i++) {
+        if (file->exports[i] == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void cj_resolve_watched_file(struct cj_watching_process* process, struct cj_watched_file* file) {
+    file->diagnostics.length = file->parse_diagnostics_length;
+
+    for (size_t i = 0; i < file->imports_length; i++) {
+        const struct cj_watched_import* import = &file->imports[i];
+        const struct cj_watched_file* dependency = import->path != NULL ? cj_find_watched_file(process, import->path) : NULL;
+
+        if (import->module == NULL && import->standard_module == NULL && (dependency == NULL || !dependency->present)) {
+            cj_report_diagnostic(&file->diagnostics, import->position, "module \"%s\" not found", import->source);
+            continue;
+        }
+
+        for (size_t j = 0; j < import->specifiers_length; j++) {
+            const struct cj_watched_specifier* specifier = &file->specifiers[import->specifiers_start + j];
+            bool exported;
+
+            if (import->module != NULL) {
+                exported = cj_find_native_export(import->module, specifier->name) != NULL;
+            } else if (import->standard_module != NULL) {
+                exported = cj_find_standard_export(import->standard_module, specifier->name) != NULL;
+            } else {
+                exported = cj_check_file_exports(dependency, specifier->name);
+            }
+
+            if (!exported) {
+                cj_report_diagnostic(&file->diagnostics, specifier->position, "module \"%s\" has no export `%s`", import->source, specifier->name);
+            }
+        }
+    }
+}
+
+static void cj_mark_file_affected(struct cj_watching_process* process, size_t index) {
+    if (!process->files[index].affected
+            && cj_grow_array(process, (void**) &process->affected, &process->affected_capacity, process->affected_length, sizeof(size_t))) {
+        process->files[index].affected = true;
+        process->affected[process->affected_length++] = index;
+    }
+}
+
+static size_t cj_count_file_errors(const struct cj_watched_file* file) {
+    return file->present ? file->diagnostics.length : 0;
+}
+
+static void cj_release_watched_file(struct cj_watching_process* process, struct cj_watched_file* file) {
+    cj_release_source_file(&file->source_file);
+    cj_release_diagnostic_list(&file->diagnostics);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, file->exports, sizeof(const char*) * file->exports_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, file->imports, sizeof(struct cj_watched_import) * file->imports_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, file->specifiers, sizeof(struct cj_watched_specifier) * file->specifiers_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, file->importers, sizeof(size_t) * file->importers_capacity);
+}
+
+/* Interns the symbol into `symbol_table`, and only points to the new copy
+ * when `move` is set, so that a failed pass leaves every string intact. */
+static bool cj_move_symbol(struct cj_symbol_table* symbol_table, const char** symbol, bool move) {
+    if (*symbol == NULL) {
+        return true;
+    }
+
+    const char* moved = cj_intern_symbol(symbol_table, *symbol, strlen(*symbol));
+    if (moved == NULL) {
+        return false;
+    }
+
+    if (move) {
+        *symbol = moved;
+    }
+    return true;
+}
+
+static bool cj_move_watched_symbols(struct cj_watching_process* process, struct cj_symbol_table* paths, struct cj_symbol_table* names, bool move) {
+    bool moved = cj_move_symbol(paths, &process->root, move);
+
+    for (size_t i = 0; moved && i < process->directories_capacity; i++) {
+        moved = cj_move_symbol(paths, &process->directories[i], move);
+    }
+
+    for (size_t i = 0; moved && i < process->files_length; i++) {
+        struct cj_watched_file* file = &process->files[i];
+        moved = cj_move_symbol(paths, &file->path, move);
+        file->source_file.path = (char*) file->path;
+
+        for (size_t j = 0; moved && j < file->imports_length; j++) {
+            moved = cj_move_symbol(paths, &file->imports[j].source, move)
+                && cj_move_symbol(paths, &file->imports[j].path, move);
+        }
+        for (size_t j = 0; moved && j < file->exports_length; j++) {
+            moved = cj_move_symbol(names, &file->exports[j], move);
+        }
+        for (size_t j = 0; moved && j < file->specifiers_length; j++) {
+            moved = cj_move_symbol(names, &file->specifiers[j].name, move);
+        }
+    }
+
+    return moved;
+}
+
+/* Forgets the files that are neither present nor imported, and rebuilds the
+ * paths and names with only the ones still referred to, so that deleted and
+ * edited files do not keep their strings for the whole session. Whatever
+ * can not be allocated is left uncompacted until the next try. */
+static void cj_compact_watching_process(struct cj_watching_process* process) {
+    size_t indices_size = sizeof(size_t) * (process->files_length + 1);
+    size_t* indices = cj_allocate(process->allocator, GENERAL_MEMORY, indices_size);
+
+    if (indices != NULL) {
+        size_t files_length = 0;
+
+        for (size_t i = 0; i < process->files_length; i++) {
+            struct cj_watched_file* file = &process->files[i];
+
+            if (!file->present && file->importers_length == 0) {
+                cj_release_watched_file(process, file);
+                indices[i] = SIZE_MAX;
+            } else {
+                indices[i] = files_length;
+                process->files[files_length++] = *file;
+            }
+        }
+        process->files_length = files_length;
+
+        /* Importers are present, so none of them was forgotten. */
+        for (size_t i = 0; i < process->files_length; i++) {
+            struct cj_watched_file* file = &process->files[i];
+            for (size_t j = 0; j < file->importers_length; j++) {
+                file->importers[j] = indices[file->importers[j]];
+                assert(file->importers[j] != SIZE_MAX);
+            }
+        }
+
+        cj_deallocate(process->allocator, GENERAL_MEMORY, indices, indices_size);
+    }
+
+    struct cj_symbol_table paths;
+    struct cj_symbol_table names;
+    cj_init_symbol_table(&paths, process->allocator);
+    cj_init_symbol_table(&names, process->allocator);
+
+    if (cj_move_watched_symbols(process, &paths, &names, false)) {
+        /* Everything is interned already, so this pass does not allocate. */
+        cj_move_watched_symbols(process, &paths, &names, true);
+        cj_release_symbol_table(&process->paths);
+        cj_release_symbol_table(&process->names);
+        process->paths = paths;
+        process->names = names;
+        process->compacted_symbols_length = paths.symbols_length + names.symbols_length;
+    } else {
+        cj_release_symbol_table(&paths);
+        cj_release_symbol_table(&names);
+    }
+
+    /* Slots are keyed by the addresses of the paths. */
+    cj_fill_file_slots(process);
+}
+
+/* Reparses the changed files, resolves the imports of those files and of
+ * every file importing them, and prints their diagnostics. Returns false,
+ * before printing anything, if memory runs out. */
+static bool cj_check_changes(struct cj_watching_process* process) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < process->changes_length; i++) {
+        process->errors -= cj_count_file_errors(&process->files[process->changes[i]]);
+        cj_parse_watched_file(process, process->changes[i]);
+        cj_mark_file_affected(process, process->changes[i]);
+    }
+
+    if (process->out_of_memory) {
+        return false;
+    }
+
+    for (size_t i = 0; i < process->changes_length; i++) {
+        const struct cj_watched_file* file = &process->files[process->changes[i]];
+
+        for (size_t j = 0; j < file->importers_length; j++) {
+            if (!process->files[file->importers[j]].affected) {
+                process->errors -= cj_count_file_errors(&process->files[file->importers[j]]);
+                cj_mark_file_affected(process, file->importers[j]);
+            }
+        }
+    }
+
+    if (process->out_of_memory) {
+        return false;
+    }
+
+    size_t checked = 0;
+
+    for (size_t i = 0; i < process->affected_length; i++) {
+        struct cj_watched_file* file = &process->files[process->affected[i]];
+
+        if (file->present) {
+            cj_resolve_watched_file(process, file);
+            cj_print_diagnostic_list(&file->diagnostics, &file->source_file);
+            process->errors += file->diagnostics.length;
+            checked++;
+        }
+
+        file->affected = false;
+        file->changed = false;
+    }
+    process->affected_length = 0;
+    process->changes_length = 0;
+
+    if (process->paths.symbols_length + process->names.symbols_length
+            > 2 * process->compacted_symbols_length + CJ_MINIMUM_COMPACTED_SYMBOLS_LENGTH) {
+        cj_compact_watching_process(process);
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double milliseconds = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+
+    printf("Checked %zu files in %.2f ms, %zu errors\n", checked, milliseconds, process->errors);
+    fflush(stdout);
+    return true;
+}
+
+static void cj_mark_directory_changed(struct cj_watching_process* process, const char* path) {
+    size_t length = strlen(path);
+
+    for (size_t i = 0; i < process->files_length; i++) {
+        if (strncmp(process->files[i].path, path, length) == 0 && process->files[i].path[length] == '/') {
+            cj_mark_file_changed(process, &process->files[i]);
+        }
+    }
+}
+
+static void cj_handle_watch_event(struct cj_watching_process* process, const struct inotify_event* event) {
+    if (event->mask & IN_Q_OVERFLOW) {
+        for (size_t i = 0; i < process->files_length; i++) {
+            cj_mark_file_changed(process, &process->files[i]);
+        }
+        cj_watch_directory(process, process->root);
+        return;
+    }
+
+    if (event->wd < 0 || (size_t) event->wd >= process->directories_capacity || process->directories[event->wd] == NULL) {
+        return;
+    }
+
+    /* The directory was deleted or moved out, so its watch is gone. */
+    if (event->mask & IN_IGNORED) {
+        process->directories[event->wd] = NULL;
+        return;
+    }
+
+    bool directory_event = (event->mask & IN_ISDIR) != 0;
+    if (event->len == 0 || event->name[0] == '.'
+            || (!directory_event && (!(event->mask & CJ_WATCH_FILE_EVENTS) || !cj_check_source_path(event->name)))) {
+        return;
+    }
+
+    const char* directory = process->directories[event->wd];
+    const char* path = cj_intern_path(process, directory, strlen(directory), event->name, "");
+
+    if (path == NULL) {
+        return;
+    }
+
+    if (directory_event) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+            cj_watch_directory(process, path);
+        } else {
+            cj_mark_directory_changed(process, path);
+        }
+    } else {
+        cj_mark_file_changed(process, cj_add_watched_file(process, path));
+    }
+}
+
+void cj_init_watching_process(struct cj_watching_process* process, struct cj_allocator* allocator) {
+    process->inotify_descriptor = -1;
+    process->allocator = allocator;
+    cj_init_parsing_process(&process->parsing_process, allocator);
+    cj_init_symbol_table(&process->paths, allocator);
+    cj_init_symbol_table(&process->names, allocator);
+    process->root = NULL;
+    process->compacted_symbols_length = 0;
+    process->directories_capacity = 0;
+    process->directories = NULL;
+    process->files_length = 0;
+    process->files_capacity = 0;
+    process->files = NULL;
+    process->files_slots_capacity = 0;
+    process->files_slots = NULL;
+    process->changes_length = 0;
+    process->changes_capacity = 0;
+    process->changes = NULL;
+    process->affected_length = 0;
+    process->affected_capacity = 0;
+    process->affected = NULL;
+    process->errors = 0;
+    process->out_of_memory = false;
+}
+
+void cj_release_watching_process(struct cj_watching_process* process) {
+    if (process->inotify_descriptor >= 0) {
+        close(process->inotify_descriptor);
+        process->inotify_descriptor = -1;
+    }
+
+    for (size_t i = 0; i < process->files_length; i++) {
+        cj_release_watched_file(process, &process->files[i]);
+    }
+
+    cj_release_parsing_process(&process->parsing_process);
+    cj_release_symbol_table(&process->paths);
+    cj_release_symbol_table(&process->names);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->directories, sizeof(const char*) * process->directories_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->files, sizeof(struct cj_watched_file) * process->files_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->files_slots, sizeof(size_t) * process->files_slots_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->changes, sizeof(size_t) * process->changes_capacity);
+    cj_deallocate(process->allocator, GENERAL_MEMORY, process->affected, sizeof(size_t) * process->affected_capacity);
+    process->directories_capacity = 0;
+    process->directories = NULL;
+    process->files_length = 0;
+    process->files_capacity = 0;
+    process->files = NULL;
+    process->files_slots_capacity = 0;
+    process->files_slots = NULL;
+    process->changes_capacity = 0;
+    process->changes = NULL;
+    process->affected_capacity = 0;
+    process->affected = NULL;
+}
+
+bool cj_watch(struct cj_watching_process* process, const char* directory) {
+    struct stat directory_stat;
+    if (stat(directory, &directory_stat) != 0 || !S_ISDIR(directory_stat.st_mode)) {
+        return false;
+    }
+
+    process->inotify_descriptor = inotify_init1(IN_CLOEXEC);
+    if (process->inotify_descriptor < 0) {
+        return false;
+    }
+
+    process->root = cj_intern_path(process, "", 0, directory, "");
+    if (process->root == NULL) {
+        return false;
+    }
+
+    cj_watch_directory(process, process->root);
+    if (process->out_of_memory || !cj_check_changes(process)) {
+        return false;
+    }
+
+    _Alignas(struct inotify_event) char buffer[64 * 1024];
+
+    while (1) {
+        ssize_t length = read(process->inotify_descriptor, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return false;
+        }
+
+        for (char* event = buffer; event < buffer + length; event += sizeof(struct inotify_event) + ((struct inotify_event*) event)->len) {
+            cj_handle_watch_event(process, (struct inotify_event*) event);
+        }
+
+        if (process->out_of_memory || (process->changes_length > 0 && !cj_check_changes(process))) {
+            return false;
+        }
+    }
+}
+
+#endif /* __linux__ */
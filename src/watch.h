@@ -0,0 +1,147 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CONJOINT_SRC_WATCH_H_
+#define CONJOINT_SRC_WATCH_H_
+
+#ifdef __linux__
+
+#include "diagnostic.h"
+#include "native_module.h"
+#include "parser.h"
+#include "source_file.h"
+#include "standard_module.h"
+#include "symbol_table.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct cj_watched_specifier {
+    const char* name;
+    size_t position;
+};
+
+/* Either `module` or `standard_module` is set, or `path` is the file the
+ * source resolves to, relative to the importing file and with the .cj
+ * suffix. */
+struct cj_watched_import {
+    const char* source;
+    const struct cj_native_module* module;
+    const struct cj_standard_module* standard_module;
+    const char* path;
+    size_t position;
+
+    size_t specifiers_start;
+    size_t specifiers_length;
+};
+
+/* What is kept of a file between changes. All strings are interned, so
+ * exports and import paths are compared by address. Only the line index of
+ * the source is kept once it is parsed. A file that is imported but absent
+ * is kept too, with `present` false, so that its importers are rechecked
+ * when it appears. */
+struct cj_watched_file {
+    const char* path;
+    bool present;
+    bool changed;
+    bool affected;
+
+    struct cj_source_file source_file;
+
+    /* Parse errors come first, errors about imports are appended to them
+     * whenever the file or one of its dependencies changes. */
+    struct cj_diagnostic_list diagnostics;
+    size_t parse_diagnostics_length;
+
+    size_t exports_length;
+    size_t exports_capacity;
+    const char** exports;
+
+    size_t imports_length;
+    size_t imports_capacity;
+    struct cj_watched_import* imports;
+
+    size_t specifiers_length;
+    size_t specifiers_capacity;
+    struct cj_watched_specifier* specifiers;
+
+    /* Indices of the files importing this one, once per import. */
+    size_t importers_length;
+    size_t importers_capacity;
+    size_t* importers;
+};
+
+/* Checks every .cj file under a directory and then keeps rechecking the
+ * files that change, along with the files importing them. */
+struct cj_watching_process {
+    int inotify_descriptor;
+    struct cj_allocator* allocator;
+
+    struct cj_parsing_process parsing_process;
+    struct cj_symbol_table paths;
+    const char* root;
+
+    /* Exported and imported names, which outlive the parse that found them. */
+    struct cj_symbol_table names;
+
+    /* Paths and names interned when both tables were last rebuilt without
+     * the ones nothing refers to any more. */
+    size_t compacted_symbols_length;
+
+    /* Watched directories indexed by inotify watch descriptor. */
+    size_t directories_capacity;
+    const char** directories;
+
+    size_t files_length;
+    size_t files_capacity;
+    struct cj_watched_file* files;
+
+    /* Open addressing table of file indices plus one, keyed by path. */
+    size_t files_slots_capacity;
+    size_t* files_slots;
+
+    size_t changes_length;
+    size_t changes_capacity;
+    size_t* changes;
+
+    /* Changed files followed by the files importing them. */
+    size_t affected_length;
+    size_t affected_capacity;
+    size_t* affected;
+
+    /* Diagnostics of all present files. */
+    size_t errors;
+
+    /* Set when a table could not grow, which stops the watch. */
+    bool out_of_memory;
+};
+
+void cj_init_watching_process(struct cj_watching_process* process, struct cj_allocator* allocator);
+
+void cj_release_watching_process(struct cj_watching_process* process);
+
+/* Only returns, with false, if the directory can not be watched or memory
+ * runs out, which sets `out_of_memory`. */
+bool cj_watch(struct cj_watching_process* process, const char* directory);
+
+#endif /* __linux__ */
+
+#endif /* CONJOINT_SRC_WATCH_H_ */
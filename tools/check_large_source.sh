@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+#
+# Checks that positions past 4 GB are reported correctly. The source is a
+# sparse file whose hole sits in a comment, followed by a declaration with a
+# type error, so the reported line depends on offsets above 2^32 with the
+# default size. The comment is copied into the tree, so the check needs
+# about twice as much free memory as the file is large.
+#
+# Usage: tools/check_large_source.sh [CONJOINT] [BYTES]
+
+set -e
+
+conjoint=${1:-./build/Default/conjoint}
+bytes=${2:-5000000000}
+directory=$(mktemp -d)
+trap 'rm -rf "$directory"' EXIT
+source="$directory/large.cj"
+
+printf 'import {printLine} from "io";\n# ' > "$source"
+truncate -s "$bytes" "$source"
+printf '\nlet x:Number = "text";\n' >> "$source"
+
+expected="$source:3:16: error: \`Number\` can not be initialized with \`String\`"
+actual=$("$conjoint" "$source" 2>&1 || true)
+
+if [ "$actual" = "$expected" ]; then
+    echo "large source checked ($(stat -c %s "$source") bytes)"
+else
+    echo "expected: $expected" >&2
+    echo "actual:   $actual" >&2
+    exit 1
+fi
@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+#
+# Checks that indexing a source again replaces its sites, and that the
+# stored index is written again instead of growing once the appended
+# segments are as long as the written ones: a source indexed twice is
+# stored twice, and once again after a third time. Lookups go through a small
+# reader built from tools/find_indexed_name.c.
+#
+# Usage: tools/check_name_index.sh [CONJOINT]
+
+set -e
+
+conjoint=${1:-./build/Default/conjoint}
+cc=${CC:-cc}
+root=$(cd "$(dirname "$0")/.." && pwd)
+directory=$(mktemp -d)
+trap 'rm -rf "$directory"' EXIT
+index="$directory/names.index"
+first="$directory/first.cj"
+second="$directory/second.cj"
+
+"$cc" -std=c11 -o "$directory/find_indexed_name" "$root/tools/find_indexed_name.c" "$root/src/name_index.c" "$root/src/allocator.c"
+
+fail() {
+    echo "$1" >&2
+    exit 1
+}
+
+expect_sites() {
+    local actual
+    actual=$("$directory/find_indexed_name" "$index" "$1")
+    if [ "$actual" != "$2" ]; then
+        printf 'sites of %s\nexpected:\n%s\nactual:\n%s\n' "$1" "$2" "$actual" >&2
+        exit 1
+    fi
+}
+
+printf 'let a:Number = 1;\nlet b:Number = a + a;\n' > "$first"
+printf 'let c:Number = 2;\n' > "$second"
+
+"$conjoint" --index "$index" "$first" > /dev/null
+size=$(stat -c %s "$index")
+
+"$conjoint" --index "$index" "$first" > /dev/null
+[ "$(stat -c %s "$index")" -lt $((2 * size)) ] || fail "indexing $first twice stored $(stat -c %s "$index") bytes, $size once"
+expect_sites a "declaration $first 4 5
+reference $first 33 34
+reference $first 37 38"
+
+"$conjoint" --index "$index" "$first" > /dev/null
+[ "$(stat -c %s "$index")" = "$size" ] || fail "indexing $first a third time stored $(stat -c %s "$index") bytes, $size once"
+expect_sites a "declaration $first 4 5
+reference $first 33 34
+reference $first 37 38"
+
+"$conjoint" --index "$index" "$second" > /dev/null
+printf 'let a:Number = 1;\nlet b:Number = a;\n' > "$first"
+"$conjoint" --index "$index" "$first" > /dev/null
+expect_sites a "declaration $first 4 5
+reference $first 33 34"
+expect_sites c "declaration $second 4 5"
+
+for i in 1 2 3 4 5 6 7 8; do
+    "$conjoint" --index "$index" "$first" > /dev/null
+done
+[ "$(stat -c %s "$index")" -lt $((3 * size)) ] || fail "reindexing $first let the stored index grow to $(stat -c %s "$index") bytes"
+expect_sites a "declaration $first 4 5
+reference $first 33 34"
+expect_sites c "declaration $second 4 5"
+
+echo "name index checked ($(stat -c %s "$index") bytes)"
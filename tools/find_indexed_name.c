@@ -0,0 +1,71 @@
+/* Copyright (c) 2014 Vyacheslav Slinko
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* Prints the declarations and references of a name in a stored index, one
+ * per line as `declaration PATH START END` or `reference PATH START END`.
+ * Built by tools/check_name_index.sh against the front end sources. */
+
+#include "../src/allocator.h"
+#include "../src/name_index.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void print_name_sites(const struct cj_name_index* index, const struct cj_indexed_name* name, enum cj_name_site_type type) {
+    for (const struct cj_name_site* site = cj_get_first_name_site(index, name, type); site != NULL; site = cj_get_next_name_site(index, site)) {
+        printf("%s %s %zu %zu\n", type == DECLARATION_SITE ? "declaration" : "reference", index->files[site->file].path, site->start, site->end);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s INDEX_FILE NAME\n", argv[0]);
+        return 1;
+    }
+
+    FILE* stream = fopen(argv[1], "rb");
+    if (stream == NULL) {
+        fprintf(stderr, "Unable to open index \"%s\"\n", argv[1]);
+        return 2;
+    }
+
+    struct cj_allocator allocator;
+    cj_init_allocator(&allocator);
+
+    struct cj_name_index index;
+    cj_init_name_index(&index, &allocator);
+
+    int status = 0;
+    if (cj_read_name_index(&index, stream)) {
+        const struct cj_indexed_name* name = cj_find_indexed_name(&index, argv[2], strlen(argv[2]));
+        if (name != NULL) {
+            print_name_sites(&index, name, DECLARATION_SITE);
+            print_name_sites(&index, name, REFERENCE_SITE);
+        }
+    } else {
+        fprintf(stderr, "Unable to read index \"%s\"\n", argv[1]);
+        status = 2;
+    }
+
+    cj_release_name_index(&index);
+    fclose(stream);
+    return status;
+}